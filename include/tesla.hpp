@@ -32,17 +32,32 @@
 #include <functional>
 #include <type_traits>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <chrono>
 #include <list>
+#include <deque>
+#include <unordered_set>
 #include <stack>
 #include <map>
 #include <filesystem>
+#include <numeric>
+#include <bit>
+#include <cassert>
+
+#if defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
 
 // Define this makro before including tesla.hpp in your main file. If you intend
 // to use the tesla.hpp header in more than one source file, only define it once!
 // #define TESLA_INIT_IMPL
 
+// Define this makro in one source file to have the compiler check the renderer's lookup tables
+// against the formulas they replace. Going over every entry adds a few seconds to its compile time
+// #define TESLA_SELF_TEST
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 
@@ -113,6 +128,9 @@ namespace tsl {
         constexpr u32 TrackBarDefaultHeight         = 90;       ///< Standard track bar height
         constexpr u8  ListItemHighlightSaturation   = 6;        ///< Maximum saturation of Listitem highlights
         constexpr u8  ListItemHighlightLength       = 22;       ///< Maximum length of Listitem highlights
+        constexpr s32 ElementHighlightMargin        = 13;       ///< Space around a element its highlight and shake animation can draw to
+        constexpr auto ListItemScrollDelay          = 1500ms;   ///< Time a truncated list item's text stays still before it starts scrolling
+        constexpr u32 ListItemScrollSpeed           = 60;       ///< Speed truncated list item text scrolls at in pixels per second
 
         namespace color {
             constexpr Color ColorFrameBackground  = { 0x0, 0x0, 0x0, 0xD };   ///< Overlay frame background color
@@ -507,519 +525,3700 @@ namespace tsl {
         };
 
         /**
-         * @brief Manages the Tesla layer and draws raw data to the screen
+         * @brief Reads a UTF-8 string one character at a time
+         * @note Runs of ASCII characters get found up front, 16 (NEON) or 8 bytes at a time, and skip \ref decode_utf8 entirely
          */
-        class Renderer final {
+        class Utf8Reader {
         public:
-            Renderer& operator=(Renderer&) = delete;
-
-            friend class tsl::Overlay;
+            /**
+             * @brief Constructor
+             *
+             * @param string String
+             * @param length Length of the string in bytes
+             */
+            Utf8Reader(const char *string, size_t length) : m_curr(string), m_asciiEnd(string), m_end(string + length) { }
 
             /**
-             * @brief Handles opacity of drawn colors for fadeout. Pass all colors through this function in order to apply opacity properly
+             * @brief Decodes the next character
              *
-             * @param c Original color
-             * @return Color with applied opacity
+             * @param codepoint Receives the character's codepoint
+             * @return Bytes the character took up. 0 at the end of the string and negative for invalid UTF-8, like \ref decode_utf8
              */
-            static Color a(const Color &c) {
-                return (c.rgba & 0x0FFF) | (static_cast<u8>(c.a * Renderer::s_opacity) << 12);
+            ALWAYS_INLINE ssize_t next(u32 &codepoint) {
+                if (this->m_curr >= this->m_asciiEnd) {
+                    if (this->m_curr >= this->m_end)
+                        return 0;
+
+                    this->m_asciiEnd = this->m_curr + getAsciiLength(this->m_curr, this->m_end - this->m_curr);
+                }
+
+                if (this->m_curr < this->m_asciiEnd) {
+                    codepoint = static_cast<u8>(*this->m_curr);
+                    if (codepoint == '\0')
+                        return 0;
+
+                    this->m_curr++;
+                    return 1;
+                }
+
+                const ssize_t codepointWidth = decode_utf8(&codepoint, reinterpret_cast<const u8*>(this->m_curr));
+                if (codepointWidth > 0)
+                    this->m_curr += codepointWidth;
+
+                return codepointWidth;
             }
 
             /**
-             * @brief Enables scissoring, discarding of any draw outside the given boundaries
+             * @brief Gets the position of the next character
              *
-             * @param x x pos
-             * @param y y pos
-             * @param w Width
-             * @param h Height
+             * @return Position
              */
-            inline void enableScissoring(s32 x, s32 y, s32 w, s32 h) {
-                this->m_scissoringStack.emplace(x, y, w, h);
+            inline const char* getPosition() const {
+                return this->m_curr;
             }
 
             /**
-             * @brief Disables scissoring
+             * @brief Counts the ASCII characters at the start of a string
+             *
+             * @param string String
+             * @param length Bytes to check at most
+             * @return Number of leading bytes below 0x80
              */
-            inline void disableScissoring() {
-                this->m_scissoringStack.pop();
+            static size_t getAsciiLength(const char *string, size_t length) {
+                size_t i = 0;
+
+            #if defined(__ARM_NEON)
+                for (; i + 16 <= length; i += 16) {
+                    if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const u8*>(string + i))) >= 0x80)
+                        break;
+                }
+            #endif
+
+                for (; i + 8 <= length; i += 8) {
+                    u64 word;
+                    std::memcpy(&word, string + i, sizeof(word));
+
+                    if (word & 0x8080'8080'8080'8080)
+                        break;
+                }
+
+                while (i < length && static_cast<u8>(string[i]) < 0x80)
+                    i++;
+
+                return i;
             }
 
+        private:
+            const char *m_curr;
+            const char *m_asciiEnd;         ///< End of the ASCII run the reader is in
+            const char *m_end;
+        };
 
-            // Drawing functions
+        /**
+         * @brief RGBA8888 bitmap converted once into the framebuffer's RGBA4444 format
+         * @note Each row is split into runs of opaque and partially transparent pixels. Fully transparent pixels aren't part of any run
+         *       so drawing skips them, and opaque runs get copied instead of blended
+         */
+        class Texture {
+        public:
+            /**
+             * @brief Run of visible pixels within one row
+             */
+            struct Run {
+                u16 x;              ///< First pixel of the run
+                u16 length;         ///< Number of pixels
+                bool opaque;        ///< All pixels of the run are fully opaque
+            };
+
+            Texture() = default;
 
             /**
-             * @brief Draw a single pixel onto the screen
+             * @brief Converts a RGBA8888 bitmap
              *
-             * @param x X pos
-             * @param y Y pos
-             * @param color Color
+             * @param rgba Pointer to bitmap data
+             * @param w Bitmap width
+             * @param h Bitmap height
              */
-            inline void setPixel(s32 x, s32 y, Color color) {
-                if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
-                    return;
+            Texture(const u8 *rgba, u16 w, u16 h) : m_width(w), m_height(h) {
+                this->m_pixels.resize(w * h);
+                this->m_rowRuns.reserve(h + 1);
 
-                u32 offset = this->getPixelOffset(x, y);
+                for (u16 y = 0; y < h; y++) {
+                    this->m_rowRuns.push_back(this->m_runs.size());
 
-                if (offset != UINT32_MAX)
-                    static_cast<Color*>(this->getCurrentFramebuffer())[offset] = color;
+                    for (u16 x = 0; x < w; x++) {
+                        const u8 *pixel = rgba + (y * w + x) * 4;
+                        const Color color = { static_cast<u8>(pixel[0] >> 4), static_cast<u8>(pixel[1] >> 4), static_cast<u8>(pixel[2] >> 4), static_cast<u8>(pixel[3] >> 4) };
+
+                        this->m_pixels[y * w + x] = color.rgba;
+
+                        if (color.a == 0x0)
+                            continue;
+
+                        const bool opaque = color.a == 0xF;
+                        if (this->m_runs.size() > this->m_rowRuns.back()) {
+                            auto &run = this->m_runs.back();
+                            if (run.x + run.length == x && run.opaque == opaque) {
+                                run.length++;
+                                continue;
+                            }
+                        }
+
+                        this->m_runs.push_back({ x, 1, opaque });
+                    }
+                }
+
+                this->m_rowRuns.push_back(this->m_runs.size());
             }
 
+            inline u16 getWidth() const { return this->m_width; }
+            inline u16 getHeight() const { return this->m_height; }
+
             /**
-             * @brief Blends two colors
+             * @brief Gets the converted pixels of a row
              *
-             * @param src Source color
-             * @param dst Destination color
-             * @param alpha Opacity
-             * @return Blended color
+             * @param y Row
+             * @return RGBA4444 pixels
              */
-            inline u8 blendColor(u8 src, u8 dst, u8 alpha) {
-                u8 oneMinusAlpha = 0x0F - alpha;
-
-                return (dst * alpha + src * oneMinusAlpha) / float(0xF);
+            inline const u16* getRow(u16 y) const {
+                return this->m_pixels.data() + y * this->m_width;
             }
 
             /**
-             * @brief Draws a single source blended pixel onto the screen
+             * @brief Calls a function for every run of visible pixels in a row
              *
-             * @param x X pos
-             * @param y Y pos
-             * @param color Color
+             * @param y Row
+             * @param f Callback taking the run
              */
-            inline void setPixelBlendSrc(s32 x, s32 y, Color color) {
-                if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
-                    return;
+            template<typename F>
+            inline void forEachRun(u16 y, F f) const {
+                for (u32 i = this->m_rowRuns[y]; i < this->m_rowRuns[y + 1]; i++)
+                    f(this->m_runs[i]);
+            }
 
-                u32 offset = this->getPixelOffset(x, y);
+        private:
+            u16 m_width = 0, m_height = 0;
+            std::vector<u16> m_pixels;
+            std::vector<Run> m_runs;
+            std::vector<u32> m_rowRuns;     ///< Index of the first run of each row, plus one past the last run
+        };
 
-                if (offset == UINT32_MAX)
-                    return;
+        /**
+         * @brief Least recently used cache of rasterized glyphs with a memory budget
+         * @note Glyph coverage is stored with 4 bit per pixel, two pixels per byte with the left one in the lower nibble, packed into shared atlas pages.
+         *       Glyphs handed out stay valid until the next call to \ref evict or \ref trim, so draw commands recorded during a frame can keep pointing to them
+         */
+        class GlyphCache {
+        public:
+            static constexpr u32 SizeSubdivisions = 64;             ///< Font sizes are keyed in steps of 1/64 pixel
+            static constexpr u8 MaxSubpixelPhases = 8;              ///< Glyphs can be rasterized shifted right in steps of 1/8 pixel
+            static constexpr size_t DefaultBudget = 512 * 1024;
+            static constexpr u16 PageWidth = 256, PageHeight = 128;    ///< Size of an atlas page in pixels. Larger glyphs get a page of their own
+            static constexpr u32 PagePadding = 8;                       ///< Bytes past the end of every page so coverage can be read 8 bytes at a time
+            static constexpr size_t MaxAsciiTables = 32;                ///< ASCII tables kept past \ref evict, about 1 KB each
 
-                Color src((static_cast<u16*>(this->getCurrentFramebuffer()))[offset]);
-                Color dst(color);
-                Color end(0);
+            /**
+             * @brief Kind of pixels in a coverage run. Each run is stored as one byte, the type in the upper 2 bits and the length minus one in the lower 6
+             */
+            enum class RunType : u8 {
+                Skip,           ///< Empty pixels
+                Solid,          ///< Fully covered pixels
+                Partial         ///< Partially covered pixels
+            };
 
-                end.r = this->blendColor(src.r, dst.r, dst.a);
-                end.g = this->blendColor(src.g, dst.g, dst.a);
-                end.b = this->blendColor(src.b, dst.b, dst.a);
-                end.a = src.a;
+            static constexpr u8 MaxRunLength = 64;
+
+            struct Glyph {
+                stbtt_fontinfo *currFont;
+                float currFontSize;
+                int bounds[4];
+                int xAdvance;
+                const u8 *glyphBmp;         ///< Packed coverage of the top left pixel, nullptr for empty glyphs
+                int width, height;
+                int stride;                 ///< Bytes per row of coverage
+                const u16 *rowRuns;         ///< Index of each row's first run in runs, nullptr if there are too many runs to index
+                const u8 *runs;             ///< Runs covering each row from left to right, see \ref RunType. nullptr if there are too many runs to index
+            };
 
-                this->setPixel(x, y, end);
+            /**
+             * @brief Cache usage counters
+             */
+            struct Stats {
+                u64 hits = 0;               ///< Lookups that found their glyph
+                u64 misses = 0;             ///< Lookups that had to rasterize their glyph
+                u64 evictions = 0;          ///< Glyphs dropped to stay within the budget
+                u64 insertions = 0;         ///< Glyphs added
+                size_t usedBytes = 0;       ///< Memory held by atlas pages and glyph bookkeeping
+                size_t glyphCount = 0;      ///< Number of cached glyphs
+                size_t pageCount = 0;       ///< Number of atlas pages
+            };
+
+            struct AsciiTable;
+
+            GlyphCache() = default;
+            GlyphCache(const GlyphCache&) = delete;
+            GlyphCache& operator=(const GlyphCache&) = delete;
+
+            ~GlyphCache() {
+                this->trim();
             }
 
             /**
-             * @brief Draws a single destination blended pixel onto the screen
+             * @brief Builds the key of a glyph
              *
-             * @param x X pos
-             * @param y Y pos
-             * @param color Color
+             * @param codepoint Unicode codepoint
+             * @param monospace Glyph uses monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @param phase Subpixel shift the glyph is rasterized with in 1/\ref MaxSubpixelPhases pixels
+             * @return Key
              */
-            inline void setPixelBlendDst(s32 x, s32 y, Color color) {
-                if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
-                    return;
+            static constexpr u64 makeKey(u32 codepoint, bool monospace, u32 fontSize, u8 phase = 0) {
+                return static_cast<u64>(codepoint) << 32 | static_cast<u64>(monospace) << 31 | static_cast<u64>(phase & 0x7) << 28 | (fontSize & 0x0FFF'FFFF);
+            }
 
-                u32 offset = this->getPixelOffset(x, y);
+            /**
+             * @brief Looks up a glyph and marks it as most recently used
+             *
+             * @param key Glyph key
+             * @return Glyph or nullptr if it isn't cached
+             */
+            Glyph* find(u64 key) {
+                auto it = this->m_index.find(key);
+                if (it == this->m_index.end()) {
+                    this->m_stats.misses++;
+                    return nullptr;
+                }
 
-                if (offset == UINT32_MAX)
-                    return;
+                this->m_stats.hits++;
+                this->m_entries.splice(this->m_entries.begin(), this->m_entries, it->second);
 
-                Color src((static_cast<u16*>(this->getCurrentFramebuffer()))[offset]);
-                Color dst(color);
-                Color end(0);
+                return &it->second->glyph;
+            }
 
-                end.r = this->blendColor(src.r, dst.r, dst.a);
-                end.g = this->blendColor(src.g, dst.g, dst.a);
-                end.b = this->blendColor(src.b, dst.b, dst.a);
-                end.a = std::min(dst.a + src.a, 0xF);
+            /**
+             * @brief Gets the table \ref findAscii looks up the ASCII glyphs of one font size and subpixel phase in
+             * @note Tables stay valid until the next call to \ref evict or \ref trim
+             *
+             * @param monospace Glyphs use monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @param phase Subpixel phase, see \ref makeKey
+             * @return Table
+             */
+            AsciiTable& getAsciiTable(bool monospace, u32 fontSize, u8 phase = 0) {
+                const u64 key = makeKey(0, monospace, fontSize, phase);
+
+                auto &table = this->m_asciiTables[key];
+                if (table == nullptr) {
+                    table = std::make_unique<AsciiTable>();
+                    table->key = key;
+                    table->entries.fill(this->m_entries.end());
+                }
 
-                this->setPixel(x, y, end);
+                return *table;
             }
 
             /**
-             * @brief Draws a rectangle of given sizes
+             * @brief Looks up a ASCII glyph and marks it as most recently used, like \ref find but without hashing its key
              *
-             * @param x X pos
-             * @param y Y pos
-             * @param w Width
-             * @param h Height
-             * @param color Color
+             * @param table Table of the glyph's font size
+             * @param character ASCII character
+             * @return Glyph or nullptr if it isn't cached
              */
-            inline void drawRect(s32 x, s32 y, s32 w, s32 h, Color color) {
-                for (s32 x1 = x; x1 < (x + w); x1++)
-                    for (s32 y1 = y; y1 < (y + h); y1++)
-                        this->setPixelBlendDst(x1, y1, color);
-            }
+            Glyph* findAscii(AsciiTable &table, u8 character) {
+                auto &entry = table.entries[character];
+
+                if (entry == this->m_entries.end()) {
+                    auto it = this->m_index.find(table.key | static_cast<u64>(character) << 32);
+                    if (it == this->m_index.end()) {
+                        this->m_stats.misses++;
+                        return nullptr;
+                    }
 
-            void drawCircle(s32 centerX, s32 centerY, u16 radius, bool filled, Color color) {
-                s32 x = radius;
-                s32 y = 0;
-                s32 radiusError = 0;
-                s32 xChange = 1 - (radius << 1);
-                s32 yChange = 0;
+                    entry = it->second;
+                }
 
-                while (x >= y) {
-                    if(filled) {
-                        for (s32 i = centerX - x; i <= centerX + x; i++) {
-                            s32 y0 = centerY + y;
-                            s32 y1 = centerY - y;
-                            s32 x0 = i;
-
-                            this->setPixelBlendDst(x0, y0, color);
-                            this->setPixelBlendDst(x0, y1, color);
-                        }
+                this->m_stats.hits++;
+                this->m_entries.splice(this->m_entries.begin(), this->m_entries, entry);
+
+                return &entry->glyph;
+            }
 
-                        for (s32 i = centerX - y; i <= centerX + y; i++) {
-                            s32 y0 = centerY + x;
-                            s32 y1 = centerY - x;
-                            s32 x0 = i;
+            /**
+             * @brief Checks if a glyph is cached, without counting a lookup or marking it as used
+             *
+             * @param key Glyph key
+             * @return Glyph is cached
+             */
+            bool contains(u64 key) const {
+                return this->m_index.contains(key);
+            }
 
-                            this->setPixelBlendDst(x0, y0, color);
-                            this->setPixelBlendDst(x0, y1, color);
-                        }
+            /**
+             * @brief Adds a glyph and packs its coverage into an atlas page
+             *
+             * @param key Glyph key
+             * @param glyph Glyph, its size taken from width and height
+             * @param coverage 8 bit coverage of the glyph, one byte per pixel without padding. Only the upper nibble is kept
+             * @return Cached glyph
+             */
+            Glyph* insert(u64 key, const Glyph &glyph, const u8 *coverage) {
+                return this->insertWith(key, glyph, coverage != nullptr,
+                    [&](u8 *packed, s32 stride) {
+                        for (s32 y = 0; y < glyph.height; y++, packed += stride)
+                            for (s32 x = 0; x < glyph.width; x++)
+                                packed[x / 2] |= (coverage[y * glyph.width + x] >> 4) << ((x & 1) * 4);
+                    },
+                    [&](s32 x, s32 y) -> u8 {
+                        return coverage[y * glyph.width + x] >> 4;
+                    });
+            }
 
-                        y++;
-                        radiusError += yChange;
-                        yChange += 2;
-                        if (((radiusError << 1) + xChange) > 0) {
-                            x--;
-                            radiusError += xChange;
-                            xChange += 2;
-                        }
-                    } else {
-                        this->setPixelBlendDst(centerX + x, centerY + y, color);
-                        this->setPixelBlendDst(centerX + y, centerY + x, color);
-                        this->setPixelBlendDst(centerX - y, centerY + x, color);
-                        this->setPixelBlendDst(centerX - x, centerY + y, color);
-                        this->setPixelBlendDst(centerX - x, centerY - y, color);
-                        this->setPixelBlendDst(centerX - y, centerY - x, color);
-                        this->setPixelBlendDst(centerX + y, centerY - x, color);
-                        this->setPixelBlendDst(centerX + x, centerY - y, color);
-
-                        if(radiusError <= 0) {
-                            y++;
-                            radiusError += 2 * y + 1;
-                        } else {
-                            x--;
-                            radiusError -= 2 * x + 1;
-                        }
-                    }
-                }
+            /**
+             * @brief Adds a glyph whose coverage already is packed, e.g. one read back from a file
+             *
+             * @param key Glyph key
+             * @param glyph Glyph, its size taken from width and height
+             * @param packed 4 bit coverage of the glyph, the left pixel in the lower nibble. Rows are padded to whole bytes
+             * @return Cached glyph
+             */
+            Glyph* insertPacked(u64 key, const Glyph &glyph, const u8 *packed) {
+                const s32 packedStride = (glyph.width + 1) / 2;
+
+                return this->insertWith(key, glyph, packed != nullptr,
+                    [&](u8 *dst, s32 stride) {
+                        for (s32 y = 0; y < glyph.height; y++)
+                            std::memcpy(dst + y * stride, packed + y * packedStride, packedStride);
+                    },
+                    [&](s32 x, s32 y) -> u8 {
+                        return (packed[y * packedStride + x / 2] >> ((x & 1) * 4)) & 0xF;
+                    });
             }
 
             /**
-             * @brief Draws a RGBA8888 bitmap from memory
+             * @brief Drops atlas pages until the cache fits its budget
+             * @note Pages go in the order their glyphs were least recently used, taking all other glyphs on them along
              *
-             * @param x X start position
-             * @param y Y start position
-             * @param w Bitmap width
-             * @param h Bitmap height
-             * @param bmp Pointer to bitmap data
+             * @param budget Budget in bytes
              */
-            void drawBitmap(s32 x, s32 y, s32 w, s32 h, const u8 *bmp) {
-                for (s32 y1 = 0; y1 < h; y1++) {
-                    for (s32 x1 = 0; x1 < w; x1++) {
-                        const Color color = { static_cast<u8>(bmp[0] >> 4), static_cast<u8>(bmp[1] >> 4), static_cast<u8>(bmp[2] >> 4), static_cast<u8>(bmp[3] >> 4) };
-                        setPixelBlendSrc(x + x1, y + y1, a(color));
-                        bmp += 4;
+            void evict(size_t budget) {
+                while (this->m_stats.usedBytes > budget && !this->m_entries.empty()) {
+                    const Page *page = this->m_entries.back().page;
+
+                    if (page == nullptr) {
+                        this->erase(std::prev(this->m_entries.end()));
+                        this->m_stats.evictions++;
+                        continue;
+                    }
+
+                    for (auto it = this->m_entries.begin(); it != this->m_entries.end();) {
+                        auto curr = it++;
+                        if (curr->page == page) {
+                            this->erase(curr);
+                            this->m_stats.evictions++;
+                        }
                     }
+
+                    this->freePage(page);
                 }
+
+                // Tables only speed up lookups, so they're kept out of the budget and simply dropped once there are too many
+                if (this->m_asciiTables.size() > MaxAsciiTables)
+                    this->m_asciiTables.clear();
             }
 
             /**
-             * @brief Fills the entire layer with a given color
-             *
-             * @param color Color
+             * @brief Drops all glyphs, atlas pages and ASCII tables
              */
-            inline void fillScreen(Color color) {
-                std::fill_n(static_cast<Color*>(this->getCurrentFramebuffer()), this->getFramebufferSize() / sizeof(Color), color);
+            void trim() {
+                while (!this->m_entries.empty())
+                    this->erase(this->m_entries.begin());
+
+                while (!this->m_pages.empty())
+                    this->freePage(&this->m_pages.front());
+
+                this->m_asciiTables.clear();
             }
 
             /**
-             * @brief Clears the layer (With transparency)
+             * @brief Calls a function with every cached glyph, most recently used first
              *
+             * @param f Function taking the glyph's key and the glyph
              */
-            inline void clearScreen() {
-                this->fillScreen({ 0x00, 0x00, 0x00, 0x00 });
+            template<typename F>
+            void forEachGlyph(F f) const {
+                for (const auto &entry : this->m_entries)
+                    f(entry.key, entry.glyph);
+            }
+
+            inline const Stats& getStats() const {
+                return this->m_stats;
             }
 
             /**
-             * @brief Draws a string
+             * @brief Splits every row of a coverage bitmap into runs of empty, fully and partially covered pixels
              *
-             * @param string String to draw
-             * @param monospace Draw string in monospace font
-             * @param x X pos
-             * @param y Y pos
-             * @param fontSize Height of the text drawn in pixels
-             * @param color Text color. Use transparent color to skip drawing and only get the string's dimensions
-             * @return Dimensions of drawn string
+             * @param width Width in pixels
+             * @param height Height in pixels
+             * @param getLevel Function returning the 4 bit coverage level of a pixel
+             * @param storage Receives the index of each row's first run as u16, followed by the runs. See \ref RunType
+             * @return Size of the storage in bytes, 0 with empty storage if the runs are too many to be indexed by u16
              */
-            std::pair<u32, u32> drawString(const char* string, bool monospace, s32 x, s32 y, float fontSize, Color color, ssize_t maxWidth = 0) {
-                s32 maxX = x;
-                s32 currX = x;
-                s32 currY = y;
-
-                struct Glyph {
-                    stbtt_fontinfo *currFont;
-                    float currFontSize;
-                    int bounds[4];
-                    int xAdvance;
-                    u8 *glyphBmp;
-                    int width, height;
+            template<typename L>
+            static size_t buildRuns(s32 width, s32 height, L getLevel, std::unique_ptr<u8[]> &storage) {
+                auto getType = [&](s32 x, s32 y) {
+                    const u8 level = getLevel(x, y);
+                    return level == 0x0 ? RunType::Skip : (level == 0xF ? RunType::Solid : RunType::Partial);
                 };
 
-                static std::unordered_map<u64, Glyph> s_glyphCache;
+                std::vector<u8> runs;
+                std::vector<u16> rowRuns(height);
+                for (s32 y = 0; y < height; y++) {
+                    // Bitmaps this large get drawn without runs
+                    if (runs.size() > UINT16_MAX) {
+                        storage.reset();
+                        return 0;
+                    }
 
-                do {
-                    if (maxWidth > 0 && maxWidth < (currX - x))
-                        break;
+                    rowRuns[y] = runs.size();
 
-                    u32 currCharacter;
-                    ssize_t codepointWidth = decode_utf8(&currCharacter, reinterpret_cast<const u8*>(string));
+                    for (s32 x = 0; x < width;) {
+                        const RunType type = getType(x, y);
 
-                    if (codepointWidth <= 0)
-                        break;
+                        s32 length = 1;
+                        while (x + length < width && length < MaxRunLength && getType(x + length, y) == type)
+                            length++;
+
+                        runs.push_back(static_cast<u8>(type) << 6 | (length - 1));
+                        x += length;
+                    }
+                }
 
-                    string += codepointWidth;
+                const size_t size = rowRuns.size() * sizeof(u16) + runs.size();
+                storage = std::make_unique<u8[]>(size);
+                std::memcpy(storage.get(), rowRuns.data(), rowRuns.size() * sizeof(u16));
+                std::memcpy(storage.get() + rowRuns.size() * sizeof(u16), runs.data(), runs.size());
 
-                    if (currCharacter == '\n') {
-                        maxX = std::max(currX, maxX);
+                return size;
+            }
 
-                        currX = x;
-                        currY += fontSize;
+        private:
+            struct Page {
+                std::unique_ptr<u8[]> data;
+                u32 width, height;
+                u32 shelfY = 0, shelfHeight = 0, cursorX = 0;   ///< Glyphs get placed left to right on shelves as high as their tallest glyph
+            };
 
-                        continue;
+            struct Entry {
+                u64 key;
+                Glyph glyph;
+                Page *page;
+                std::unique_ptr<u8[]> runs;         ///< Row run indices followed by the runs
+                size_t runsSize;
+            };
+
+        public:
+            /**
+             * @brief Cached ASCII glyphs of one font size and subpixel phase, indexed by character
+             * @note Slots get filled on first lookup and reset when their glyph gets evicted
+             */
+            struct AsciiTable {
+                u64 key;                                                ///< Key of the font size and phase, with an empty codepoint
+                std::array<std::list<Entry>::iterator, 0x80> entries;   ///< Glyph of each character, the end of the entry list if not looked up yet
+            };
+
+        private:
+            static constexpr size_t EntryOverhead = 4 * sizeof(void*);     ///< List and index nodes
+
+            std::list<Entry> m_entries;             ///< Most recently used glyph first
+            std::unordered_map<u64, std::list<Entry>::iterator> m_index;
+            std::unordered_map<u64, std::unique_ptr<AsciiTable>> m_asciiTables;
+            std::list<Page> m_pages;                ///< Most recently created page last
+            Stats m_stats;
+
+            static size_t getPageSize(u32 width, u32 height) {
+                return static_cast<size_t>(width / 2) * height + PagePadding;
+            }
+
+            static size_t getEntrySize(const Entry &entry) {
+                return sizeof(Entry) + EntryOverhead + entry.runsSize;
+            }
+
+            /**
+             * @brief Adds a glyph, allocating room for it on an atlas page if it has any coverage
+             *
+             * @param key Glyph key
+             * @param glyph Glyph, its size taken from width and height
+             * @param hasCoverage Glyph has coverage data
+             * @param writeCoverage Function packing the coverage into the atlas page, given the top left byte and the page's stride
+             * @param getLevel Function returning the 4 bit coverage level of a pixel
+             * @return Cached glyph
+             */
+            template<typename W, typename L>
+            Glyph* insertWith(u64 key, const Glyph &glyph, bool hasCoverage, W writeCoverage, L getLevel) {
+                this->m_entries.push_front({ key, glyph, nullptr, nullptr, 0 });
+                this->m_index[key] = this->m_entries.begin();
+
+                auto &entry = this->m_entries.front();
+                entry.glyph.glyphBmp = nullptr;
+                entry.glyph.stride = 0;
+                entry.glyph.rowRuns = nullptr;
+                entry.glyph.runs = nullptr;
+
+                if (hasCoverage && glyph.width > 0 && glyph.height > 0) {
+                    u16 pageX = 0, pageY = 0;
+                    entry.page = this->allocate(glyph.width, glyph.height, pageX, pageY);
+
+                    u8 *packed = entry.page->data.get() + pageY * (entry.page->width / 2) + pageX / 2;
+                    writeCoverage(packed, entry.page->width / 2);
+
+                    entry.glyph.glyphBmp = packed;
+                    entry.glyph.stride = entry.page->width / 2;
+
+                    entry.runsSize = buildRuns(glyph.width, glyph.height, getLevel, entry.runs);
+                    if (entry.runs != nullptr) {
+                        entry.glyph.rowRuns = reinterpret_cast<const u16*>(entry.runs.get());
+                        entry.glyph.runs = entry.runs.get() + glyph.height * sizeof(u16);
                     }
+                }
+
+                this->m_stats.usedBytes += getEntrySize(entry);
+                this->m_stats.glyphCount++;
+                this->m_stats.insertions++;
 
-                    u64 key = (static_cast<u64>(currCharacter) << 32) | static_cast<u64>(monospace) << 31 | static_cast<u64>(std::bit_cast<u32>(fontSize));
+                return &entry.glyph;
+            }
 
-                    Glyph *glyph = nullptr;
+            /**
+             * @brief Finds room for a glyph on the newest page or starts a new one
+             *
+             * @param width Glyph width
+             * @param height Glyph height
+             * @param x X pos of the glyph on the page, always even
+             * @param y Y pos of the glyph on the page
+             * @return Page
+             */
+            Page* allocate(u16 width, u16 height, u16 &x, u16 &y) {
+                const u32 paddedWidth = (static_cast<u32>(width) + 1) & ~1U;
 
-                    auto it = s_glyphCache.find(key);
-                    if (it == s_glyphCache.end()) {
-                        /* Cache glyph */
-                        glyph = &s_glyphCache.emplace(key, Glyph()).first->second;
+                if (!this->m_pages.empty()) {
+                    Page &page = this->m_pages.back();
 
-                        if (stbtt_FindGlyphIndex(&this->m_extFont, currCharacter))
-                            glyph->currFont = &this->m_extFont;
-                        else if(this->m_hasLocalFont && stbtt_FindGlyphIndex(&this->m_stdFont, currCharacter)==0)
-                            glyph->currFont = &this->m_localFont;
-                        else
-                            glyph->currFont = &this->m_stdFont;
+                    if (page.cursorX + paddedWidth > page.width) {
+                        page.shelfY += page.shelfHeight;
+                        page.shelfHeight = 0;
+                        page.cursorX = 0;
+                    }
 
-                        glyph->currFontSize = stbtt_ScaleForPixelHeight(glyph->currFont, fontSize);
+                    if (page.cursorX + paddedWidth <= page.width && page.shelfY + height <= page.height) {
+                        x = static_cast<u16>(page.cursorX);
+                        y = static_cast<u16>(page.shelfY);
+
+                        page.cursorX += paddedWidth;
+                        page.shelfHeight = std::max<u32>(page.shelfHeight, height);
+
+                        return &page;
+                    }
+                }
+
+                Page &page = this->m_pages.emplace_back();
+                page.width = std::max<u32>(PageWidth, paddedWidth);
+                page.height = std::max<u32>(PageHeight, height);
+                page.data = std::make_unique<u8[]>(getPageSize(page.width, page.height));
+                page.cursorX = paddedWidth;
+                page.shelfHeight = height;
+
+                this->m_stats.usedBytes += getPageSize(page.width, page.height);
+                this->m_stats.pageCount++;
+
+                x = 0;
+                y = 0;
+
+                return &page;
+            }
+
+            void freePage(const Page *page) {
+                auto it = std::find_if(this->m_pages.begin(), this->m_pages.end(), [page](const Page &curr) { return &curr == page; });
+
+                this->m_stats.usedBytes -= getPageSize(it->width, it->height);
+                this->m_stats.pageCount--;
+
+                this->m_pages.erase(it);
+            }
+
+            void erase(std::list<Entry>::iterator it) {
+                this->m_stats.usedBytes -= getEntrySize(*it);
+                this->m_stats.glyphCount--;
+
+                if (const u64 codepoint = it->key >> 32; codepoint < 0x80) {
+                    if (auto table = this->m_asciiTables.find(it->key & 0xFFFF'FFFF); table != this->m_asciiTables.end())
+                        table->second->entries[codepoint] = this->m_entries.end();
+                }
+
+                this->m_index.erase(it->key);
+                this->m_entries.erase(it);
+            }
+        };
+
+        /**
+         * @brief Least recently used cache of whole strings rendered into a single coverage bitmap with a memory budget
+         * @note Coverage is packed with 4 bit per pixel like in the \ref GlyphCache and split into the same runs, so a string can be drawn like one large glyph in any color.
+         *       Sprites handed out stay valid until the next call to \ref evict or \ref trim
+         */
+        class TextSpriteCache {
+        public:
+            static constexpr size_t DefaultBudget = 128 * 1024;
+            static constexpr s32 MaxPixels = 0x8000;       ///< Larger strings don't get a sprite, keeping the row run indices within 16 bit
+            static constexpr u32 Padding = 8;              ///< Bytes past the end of the coverage so it can be read 8 bytes at a time
+
+            struct Sprite {
+                s32 offsetX, offsetY;                   ///< Position of the top left pixel relative to where the string gets drawn
+                std::pair<u32, u32> dimensions;         ///< Dimensions of the string, the same as returned by \ref Renderer::drawString
+                bool drawable;                          ///< False if the string is too large to get a sprite and has to be drawn glyph by glyph
+                GlyphCache::Glyph glyph;                ///< Coverage and runs of the whole string, width and height set to the bitmap's size
+            };
+
+            TextSpriteCache() = default;
+            TextSpriteCache(const TextSpriteCache&) = delete;
+            TextSpriteCache& operator=(const TextSpriteCache&) = delete;
+
+            /**
+             * @brief Looks up a sprite and marks it as most recently used
+             *
+             * @param key Sprite key
+             * @param text String the sprite has to be of, in case two strings share a key
+             * @return Sprite or nullptr if it isn't cached
+             */
+            const Sprite* find(u64 key, const std::string &text) {
+                auto it = this->m_index.find(key);
+                if (it == this->m_index.end() || it->second->text != text)
+                    return nullptr;
+
+                this->m_entries.splice(this->m_entries.begin(), this->m_entries, it->second);
+
+                return &it->second->sprite;
+            }
+
+            /**
+             * @brief Adds a sprite
+             *
+             * @param key Sprite key
+             * @param text String the sprite is of
+             * @param sprite Sprite, the coverage and run pointers get set from the passed buffers
+             * @param coverage Packed coverage, \ref Padding bytes longer than the bitmap
+             * @param runs Row run indices followed by the runs, see \ref GlyphCache::buildRuns
+             * @param runsSize Size of the runs in bytes
+             * @return Cached sprite, nullptr if a different string with the same key is cached already
+             */
+            const Sprite* insert(u64 key, const std::string &text, const Sprite &sprite, std::unique_ptr<u8[]> coverage, std::unique_ptr<u8[]> runs, size_t runsSize) {
+                if (this->m_index.contains(key))
+                    return nullptr;
+
+                const size_t coverageSize = sprite.drawable ? sprite.glyph.stride * sprite.glyph.height + Padding : 0;
+
+                this->m_entries.push_front({ key, text, sprite, std::move(coverage), std::move(runs), sizeof(Entry) + EntryOverhead + text.capacity() + coverageSize + runsSize });
+                this->m_index[key] = this->m_entries.begin();
+
+                auto &entry = this->m_entries.front();
+                entry.sprite.glyph.glyphBmp = entry.coverage.get();
+                entry.sprite.glyph.rowRuns = nullptr;
+                entry.sprite.glyph.runs = nullptr;
+
+                if (entry.runs != nullptr) {
+                    entry.sprite.glyph.rowRuns = reinterpret_cast<const u16*>(entry.runs.get());
+                    entry.sprite.glyph.runs = entry.runs.get() + sprite.glyph.height * sizeof(u16);
+                }
+
+                this->m_usedBytes += entry.size;
+
+                return &entry.sprite;
+            }
+
+            /**
+             * @brief Drops the least recently used sprites until the cache fits its budget
+             *
+             * @param budget Budget in bytes
+             */
+            void evict(size_t budget) {
+                while (this->m_usedBytes > budget && !this->m_entries.empty()) {
+                    this->m_usedBytes -= this->m_entries.back().size;
+                    this->m_index.erase(this->m_entries.back().key);
+                    this->m_entries.pop_back();
+                }
+            }
+
+            /**
+             * @brief Drops all sprites
+             */
+            void trim() {
+                this->evict(0);
+            }
+
+            inline size_t getUsedBytes() const {
+                return this->m_usedBytes;
+            }
+
+        private:
+            struct Entry {
+                u64 key;
+                std::string text;
+                Sprite sprite;
+                std::unique_ptr<u8[]> coverage;
+                std::unique_ptr<u8[]> runs;
+                size_t size;                        ///< Memory held by the entry
+            };
+
+            static constexpr size_t EntryOverhead = 4 * sizeof(void*);     ///< List and index nodes
+
+            std::list<Entry> m_entries;             ///< Most recently used sprite first
+            std::unordered_map<u64, std::list<Entry>::iterator> m_index;
+            size_t m_usedBytes = 0;
+        };
+
+        /**
+         * @brief Manages the Tesla layer and draws raw data to the screen
+         */
+        class Renderer final {
+        public:
+            Renderer& operator=(Renderer&) = delete;
+
+            using LevelTable = std::array<u8, 16>;
+
+            /**
+             * @brief Counters about the work done drawing frames
+             */
+            struct RenderStats {
+                u64 renderedFrames = 0;         ///< Number of frames drawn
+                u64 redrawnPixels = 0;          ///< Number of pixels repainted over all drawn frames
+                u32 lastRedrawnPixels = 0;      ///< Number of pixels repainted in the last drawn frame
+                u64 skippedFrames = 0;          ///< Number of frames skipped because nothing changed
+            };
+
+            /**
+             * @brief Glyphs rasterized in the background before the overlay gets shown for the first time
+             */
+            struct GlyphPrewarmSet {
+                std::string characters;         ///< UTF-8 encoded characters to rasterize
+                std::vector<float> fontSizes;   ///< Font sizes to rasterize each character in
+                bool monospace = false;
+            };
+
+            friend class tsl::Overlay;
+            friend class tsl::elm::Element;
+
+            /**
+             * @brief Handles opacity of drawn colors for fadeout. Pass all colors through this function in order to apply opacity properly
+             *
+             * @param c Original color
+             * @return Color with applied opacity
+             */
+            static Color a(const Color &c) {
+                return (c.rgba & 0x0FFF) | (Renderer::s_opacityTable[c.a] << 12);
+            }
+
+            /**
+             * @brief Enables scissoring, discarding of any draw outside the given boundaries
+             * @note The boundaries get intersected with the currently active ones, nested scissoring can only shrink the drawable area.
+             *       The right and bottom edge are part of the drawable area
+             *
+             * @param x x pos
+             * @param y y pos
+             * @param w Width
+             * @param h Height
+             */
+            inline void enableScissoring(s32 x, s32 y, s32 w, s32 h) {
+                this->pushScissoring({ x, y, w + 1, h + 1 });
+            }
+
+            /**
+             * @brief Disables scissoring
+             */
+            inline void disableScissoring() {
+                if (this->m_scissoringDepth > 0)
+                    this->m_scissoringDepth--;
+            }
+
+
+            // Drawing functions
+
+            /**
+             * @brief Draw a single pixel onto the screen
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param color Color
+             */
+            inline void setPixel(s32 x, s32 y, Color color) {
+                if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
+                    return;
+
+                u32 offset = this->getPixelOffset(x, y);
+
+                if (offset == UINT32_MAX)
+                    return;
+
+                if (this->m_recording)
+                    this->m_drawCommands.push_back({ .type = DrawCommand::Type::Fill, .x0 = x, .y0 = y, .x1 = x + 1, .y1 = y + 1, .color = color });
+                else
+                    static_cast<Color*>(this->getCurrentFramebuffer())[offset] = color;
+            }
+
+            /**
+             * @brief Blends two colors
+             *
+             * @param src Source color
+             * @param dst Destination color
+             * @param alpha Opacity
+             * @return Blended color
+             */
+            inline u8 blendColor(u8 src, u8 dst, u8 alpha) {
+                return Renderer::BlendTable[alpha][src][dst];
+            }
+
+            /**
+             * @brief Draws a single source blended pixel onto the screen
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param color Color
+             */
+            inline void setPixelBlendSrc(s32 x, s32 y, Color color) {
+                if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
+                    return;
+
+                u32 offset = this->getPixelOffset(x, y);
+
+                if (offset == UINT32_MAX)
+                    return;
+
+                if (this->m_recording) {
+                    this->m_drawCommands.push_back({ .type = DrawCommand::Type::BlendSrc, .x0 = x, .y0 = y, .x1 = x + 1, .y1 = y + 1, .color = color });
+                    return;
+                }
+
+                Color src((static_cast<u16*>(this->getCurrentFramebuffer()))[offset]);
+                Color dst(color);
+                Color end(0);
+
+                end.r = this->blendColor(src.r, dst.r, dst.a);
+                end.g = this->blendColor(src.g, dst.g, dst.a);
+                end.b = this->blendColor(src.b, dst.b, dst.a);
+                end.a = src.a;
+
+                this->setPixel(x, y, end);
+            }
+
+            /**
+             * @brief Draws a single destination blended pixel onto the screen
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param color Color
+             */
+            inline void setPixelBlendDst(s32 x, s32 y, Color color) {
+                if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
+                    return;
+
+                u32 offset = this->getPixelOffset(x, y);
+
+                if (offset == UINT32_MAX)
+                    return;
+
+                if (this->m_recording) {
+                    this->m_drawCommands.push_back({ .type = DrawCommand::Type::BlendDst, .x0 = x, .y0 = y, .x1 = x + 1, .y1 = y + 1, .color = color });
+                    return;
+                }
+
+                Color src((static_cast<u16*>(this->getCurrentFramebuffer()))[offset]);
+                Color dst(color);
+                Color end(0);
+
+                end.r = this->blendColor(src.r, dst.r, dst.a);
+                end.g = this->blendColor(src.g, dst.g, dst.a);
+                end.b = this->blendColor(src.b, dst.b, dst.a);
+                end.a = std::min(dst.a + src.a, 0xF);
+
+                this->setPixel(x, y, end);
+            }
+
+            /**
+             * @brief Draws a rectangle of given sizes
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param w Width
+             * @param h Height
+             * @param color Color
+             */
+            inline void drawRect(s32 x, s32 y, s32 w, s32 h, Color color) {
+                if (color.a == 0x0)
+                    return;
+
+                s32 x0 = x, y0 = y, x1 = x + w, y1 = y + h;
+                if (!this->clipRect(x0, y0, x1, y1))
+                    return;
+
+                this->submit({ .type = color.a == 0xF ? DrawCommand::Type::Fill : DrawCommand::Type::BlendDst, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .color = color });
+            }
+
+            /**
+             * @brief Draws a circle
+             * @note Filled circles are drawn as one span per row, so every pixel gets blended exactly once
+             *
+             * @param centerX Center X pos
+             * @param centerY Center Y pos
+             * @param radius Radius
+             * @param filled Fill the circle or only draw its outline
+             * @param color Color
+             * @param antiAliased Smooth the edge of filled circles
+             */
+            void drawCircle(s32 centerX, s32 centerY, u16 radius, bool filled, Color color, bool antiAliased = false) {
+                s32 clipX0 = centerX - radius, clipY0 = centerY - radius;
+                s32 clipX1 = centerX + radius + 1, clipY1 = centerY + radius + 1;
+                if (!this->clipRect(clipX0, clipY0, clipX1, clipY1))
+                    return;
+
+                if (filled) {
+                    if (antiAliased) {
+                        for (s32 dy = -radius; dy <= radius; dy++)
+                            this->drawSmoothRow(centerX, centerX, centerY + dy, dy, radius, color);
+                    } else {
+                        this->getCircleHalfWidths(radius, this->m_outerHalfWidths);
+
+                        for (s32 dy = -radius; dy <= radius; dy++) {
+                            const s32 halfWidth = this->m_outerHalfWidths[std::abs(dy)];
+                            if (halfWidth >= 0)
+                                this->drawRect(centerX - halfWidth, centerY + dy, 2 * halfWidth + 1, 1, color);
+                        }
+                    }
+
+                    return;
+                }
+
+                s32 x = radius;
+                s32 y = 0;
+                s32 radiusError = 0;
+
+                while (x >= y) {
+                    this->setPixelBlendDst(centerX + x, centerY + y, color);
+                    this->setPixelBlendDst(centerX + y, centerY + x, color);
+                    this->setPixelBlendDst(centerX - y, centerY + x, color);
+                    this->setPixelBlendDst(centerX - x, centerY + y, color);
+                    this->setPixelBlendDst(centerX - x, centerY - y, color);
+                    this->setPixelBlendDst(centerX - y, centerY - x, color);
+                    this->setPixelBlendDst(centerX + y, centerY - x, color);
+                    this->setPixelBlendDst(centerX + x, centerY - y, color);
+
+                    if(radiusError <= 0) {
+                        y++;
+                        radiusError += 2 * y + 1;
+                    } else {
+                        x--;
+                        radiusError -= 2 * x + 1;
+                    }
+                }
+            }
+
+            /**
+             * @brief Draws a ring
+             * @note Drawn as at most two spans per row. Rings at least as thick as their radius are drawn as filled circles
+             *
+             * @param centerX Center X pos
+             * @param centerY Center Y pos
+             * @param radius Outer radius
+             * @param thickness Thickness of the ring
+             * @param color Color
+             * @param antiAliased Smooth the inner and outer edge
+             */
+            void drawRing(s32 centerX, s32 centerY, u16 radius, u16 thickness, Color color, bool antiAliased = false) {
+                if (thickness == 0)
+                    return;
+
+                if (thickness >= radius) {
+                    this->drawCircle(centerX, centerY, radius, true, color, antiAliased);
+                    return;
+                }
+
+                s32 clipX0 = centerX - radius, clipY0 = centerY - radius;
+                s32 clipX1 = centerX + radius + 1, clipY1 = centerY + radius + 1;
+                if (!this->clipRect(clipX0, clipY0, clipX1, clipY1))
+                    return;
+
+                const s32 innerRadius = radius - thickness;
+
+                if (antiAliased) {
+                    for (s32 dy = -radius; dy <= radius; dy++) {
+                        const s32 outer = isqrt(radius * radius + 2 * radius - dy * dy);
+                        const s32 holeSquared = innerRadius * innerRadius - 1 - dy * dy;
+                        const s32 hole = holeSquared >= 0 ? isqrt(holeSquared) : -1;
+
+                        auto coverage = [&](s32 x) {
+                            const s32 dx = x - centerX;
+                            return std::min<u8>(circleCoverage(dx, dy, radius), 0xF - circleCoverage(dx, dy, innerRadius));
+                        };
+
+                        if (hole >= 0) {
+                            this->drawCoverageSpan(centerX - outer, centerX - hole, centerY + dy, color, coverage);
+                            this->drawCoverageSpan(centerX + hole + 1, centerX + outer + 1, centerY + dy, color, coverage);
+                        } else {
+                            this->drawCoverageSpan(centerX - outer, centerX + outer + 1, centerY + dy, color, coverage);
+                        }
+                    }
+                } else {
+                    this->getCircleHalfWidths(radius, this->m_outerHalfWidths);
+                    this->getCircleHalfWidths(innerRadius, this->m_innerHalfWidths);
+
+                    for (s32 dy = -radius; dy <= radius; dy++) {
+                        const s32 outer = this->m_outerHalfWidths[std::abs(dy)];
+                        const s32 hole = std::abs(dy) <= innerRadius ? this->m_innerHalfWidths[std::abs(dy)] : -1;
+
+                        if (outer < 0)
+                            continue;
+
+                        if (hole >= 0) {
+                            this->drawRect(centerX - outer, centerY + dy, outer - hole, 1, color);
+                            this->drawRect(centerX + hole + 1, centerY + dy, outer - hole, 1, color);
+                        } else {
+                            this->drawRect(centerX - outer, centerY + dy, 2 * outer + 1, 1, color);
+                        }
+                    }
+                }
+            }
+
+            /**
+             * @brief Draws a filled rectangle with rounded corners
+             * @note Drawn as one span per corner row plus a single rectangle for the straight part
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param w Width
+             * @param h Height
+             * @param radius Corner radius, limited to fit the rectangle
+             * @param color Color
+             * @param antiAliased Smooth the corners
+             */
+            void drawRoundedRect(s32 x, s32 y, s32 w, s32 h, u16 radius, Color color, bool antiAliased = false) {
+                if (w <= 0 || h <= 0)
+                    return;
+
+                s32 clipX0 = x, clipY0 = y, clipX1 = x + w, clipY1 = y + h;
+                if (!this->clipRect(clipX0, clipY0, clipX1, clipY1))
+                    return;
+
+                const s32 cornerRadius = std::min<s32>(radius, (std::min(w, h) - 1) / 2);
+                const s32 left = x + cornerRadius, right = x + w - 1 - cornerRadius;
+
+                if (!antiAliased)
+                    this->getCircleHalfWidths(cornerRadius, this->m_outerHalfWidths);
+
+                for (s32 row = 0; row < cornerRadius; row++) {
+                    const s32 dy = cornerRadius - row;
+
+                    if (antiAliased) {
+                        this->drawSmoothRow(left, right, y + row, -dy, cornerRadius, color);
+                        this->drawSmoothRow(left, right, y + h - 1 - row, dy, cornerRadius, color);
+                    } else {
+                        const s32 halfWidth = std::max(this->m_outerHalfWidths[dy], 0);
+                        this->drawRect(left - halfWidth, y + row, right - left + 2 * halfWidth + 1, 1, color);
+                        this->drawRect(left - halfWidth, y + h - 1 - row, right - left + 2 * halfWidth + 1, 1, color);
+                    }
+                }
+
+                this->drawRect(x, y + cornerRadius, w, h - 2 * cornerRadius, color);
+            }
+
+            /**
+             * @brief Draws a RGBA8888 bitmap from memory
+             *
+             * @param x X start position
+             * @param y Y start position
+             * @param w Bitmap width
+             * @param h Bitmap height
+             * @param bmp Pointer to bitmap data
+             */
+            void drawBitmap(s32 x, s32 y, s32 w, s32 h, const u8 *bmp) {
+                s32 x0 = x, y0 = y, x1 = x + w, y1 = y + h;
+                if (!this->clipRect(x0, y0, x1, y1))
+                    return;
+
+                this->submit({ .type = DrawCommand::Type::Bitmap, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .color = 0,
+                               .data = bmp, .dataX = x, .dataY = y, .dataStride = w, .alphaTable = Renderer::s_opacityTable });
+            }
+
+            /**
+             * @brief Draws a pre-converted texture
+             * @note Same result as drawing the texture's bitmap with \ref drawBitmap, without converting it every frame
+             *
+             * @param x X start position
+             * @param y Y start position
+             * @param texture Texture
+             */
+            void drawTexture(s32 x, s32 y, const Texture &texture) {
+                s32 x0 = x, y0 = y, x1 = x + texture.getWidth(), y1 = y + texture.getHeight();
+                if (!this->clipRect(x0, y0, x1, y1))
+                    return;
+
+                this->submit({ .type = DrawCommand::Type::Texture, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .color = 0,
+                               .dataX = x, .dataY = y, .alphaTable = Renderer::s_opacityTable, .texture = &texture });
+            }
+
+            /**
+             * @brief Fills the entire layer with a given color
+             * @note While scissoring is enabled only the area inside the boundaries gets filled
+             *
+             * @param color Color
+             */
+            inline void fillScreen(Color color) {
+                if (this->m_scissoringDepth == 0 && !this->m_recording) {
+                    std::fill_n(static_cast<Color*>(this->getCurrentFramebuffer()), this->getFramebufferSize() / sizeof(Color), color);
+                    return;
+                }
+
+                s32 x0 = 0, y0 = 0, x1 = cfg::FramebufferWidth, y1 = cfg::FramebufferHeight;
+                if (!this->clipRect(x0, y0, x1, y1))
+                    return;
+
+                this->submit({ .type = DrawCommand::Type::Fill, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .color = color });
+            }
+
+            /**
+             * @brief Clears the layer (With transparency)
+             *
+             */
+            inline void clearScreen() {
+                this->fillScreen({ 0x00, 0x00, 0x00, 0x00 });
+            }
+
+            /**
+             * @brief Draws a string
+             *
+             * @param string String to draw
+             * @param monospace Draw string in monospace font
+             * @param x X pos
+             * @param y Y pos
+             * @param fontSize Height of the text drawn in pixels
+             * @param color Text color. Use transparent color to skip drawing and only get the string's dimensions, though \ref measureString is cheaper
+             * @return Dimensions of drawn string
+             * @note Glyphs that can't reach the current scissor rectangle, including whole lines above or below it and everything
+             *       past its right edge, only advance the pen and never get rasterized.
+             *       The pen moves in fractions of a pixel, glyphs get drawn at the closest of the subpixel phases set by \ref setSubpixelPhases
+             */
+            std::pair<u32, u32> drawString(const char* string, bool monospace, s32 x, s32 y, float fontSize, Color color, ssize_t maxWidth = 0) {
+                const s32 startPen = x * PenSubdivisions;
+                s32 maxPen = startPen;
+                s32 currPen = startPen;
+                s32 currY = y;
+
+                const u32 cachedFontSize = std::max(fontSize, 0.0F) * GlyphCache::SizeSubdivisions + 0.5F;
+                const auto &coverageAlpha = Renderer::CoverageTable[color.a];
+
+                // Glyph pixel bounds get rounded outwards and shifted by up to one pixel for their phase, two extra pixels cover both
+                const auto clip = this->getScissoringConfig();
+                const float scaledFontSize = static_cast<float>(cachedFontSize) / GlyphCache::SizeSubdivisions;
+                const s32 reachLeft   = std::ceil(this->m_glyphExtents.left * scaledFontSize) + 2;
+                const s32 reachRight  = std::ceil(this->m_glyphExtents.right * scaledFontSize) + 2;
+                const s32 reachTop    = std::ceil(this->m_glyphExtents.top * scaledFontSize) + 2;
+                const s32 reachBottom = std::ceil(this->m_glyphExtents.bottom * scaledFontSize) + 2;
+
+                auto isLineVisible = [&](s32 baseline) {
+                    return color.a != 0x0 && baseline + reachBottom > clip.y && baseline - reachTop < clip.y + clip.h;
+                };
+
+                bool lineVisible = isLineVisible(currY);
+
+                // ASCII characters skip the UTF-8 decoder and get their glyphs and advances from tables indexed by character
+                Utf8Reader reader(string, std::strlen(string));
+                std::array<GlyphCache::AsciiTable*, GlyphCache::MaxSubpixelPhases> asciiGlyphs = {};
+                const AsciiAdvances *asciiAdvances = nullptr;
+
+                while (true) {
+                    if (maxWidth > 0 && maxWidth * PenSubdivisions < (currPen - startPen))
+                        break;
+
+                    u32 currCharacter;
+                    if (reader.next(currCharacter) <= 0)
+                        break;
+
+                    if (currCharacter == '\n') {
+                        maxPen = std::max(currPen, maxPen);
+
+                        currPen = startPen;
+                        currY += fontSize;
+
+                        lineVisible = isLineVisible(currY);
+
+                        continue;
+                    }
+
+                    const s32 currX = currPen >> PenFractionBits;
+                    if (!lineVisible || currX - reachLeft >= clip.x + clip.w || currX + reachRight <= clip.x) {
+                        if (currCharacter < 0x80) {
+                            if (asciiAdvances == nullptr)
+                                asciiAdvances = &this->getAsciiAdvances(monospace, cachedFontSize);
+
+                            currPen += (*asciiAdvances)[currCharacter];
+                        } else {
+                            currPen += this->getGlyphAdvance(currCharacter, monospace, cachedFontSize);
+                        }
+
+                        continue;
+                    }
+
+                    u8 phase;
+                    const s32 penX = snapPen(currPen, phase);
+                    const u64 key = GlyphCache::makeKey(currCharacter, monospace, cachedFontSize, phase);
+
+                    GlyphCache::Glyph *glyph;
+                    if (currCharacter < 0x80) {
+                        if (asciiGlyphs[phase] == nullptr)
+                            asciiGlyphs[phase] = &this->m_glyphCache.getAsciiTable(monospace, cachedFontSize, phase);
+
+                        glyph = this->m_glyphCache.findAscii(*asciiGlyphs[phase], currCharacter);
+                    } else {
+                        glyph = this->m_glyphCache.find(key);
+                    }
+
+                    if (glyph == nullptr) {
+                        const GlyphLocation location = this->lookupGlyph(currCharacter);
+
+                        // Once this frame used up its rasterization budget, glyphs get rasterized in the background and a placeholder takes their place for now
+                        const bool queued = this->m_queuedGlyphs.contains(key) ||
+                            (armTicksToNs(this->m_glyphRasterizationTicks) >= Renderer::s_glyphRasterizationBudgetNs && this->queueGlyph({ key, location, cachedFontSize, monospace, phase }));
+
+                        if (queued) {
+                            if (!std::iswspace(currCharacter) && fontSize > 0 && color.a != 0x0)
+                                this->drawGlyphPlaceholder(location, cachedFontSize, phase, penX, currY);
+
+                            currPen += this->getGlyphAdvance(currCharacter, monospace, cachedFontSize);
+                            continue;
+                        }
+
+                        glyph = this->cacheGlyph(key, location, monospace, cachedFontSize, phase);
+                    }
+
+                    if (glyph->glyphBmp != nullptr && !std::iswspace(currCharacter) && fontSize > 0 && color.a != 0x0) {
+
+                        const s32 glyphX = penX + glyph->bounds[0];
+                        const s32 glyphY = currY + glyph->bounds[1];
+
+                        s32 x0 = glyphX, y0 = glyphY, x1 = glyphX + glyph->width, y1 = glyphY + glyph->height;
+                        if (this->clipRect(x0, y0, x1, y1)) {
+                            const auto type = glyph->runs != nullptr ? DrawCommand::Type::Glyph : DrawCommand::Type::Coverage;
+                            this->submit({ .type = type, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .color = color,
+                                           .data = glyph->glyphBmp, .dataX = glyphX, .dataY = glyphY, .dataStride = glyph->stride, .alphaTable = coverageAlpha, .glyph = glyph });
+                        }
+
+                    }
+
+                    currPen += toPenAdvance(glyph->xAdvance, glyph->currFontSize);
+
+                }
+
+                maxPen = std::max(currPen, maxPen);
+
+                return { penToPixels(maxPen - startPen), currY - y };
+            }
+
+            /**
+             * @brief Draws a string that stays the same over many frames, e.g. a title or a label
+             * @note The string gets rendered into a sprite once, which then gets drawn in one go in any color. Sprites are kept in a cache of their own, see \ref setTextSpriteCacheBudget.
+             *       Strings too large for a sprite get drawn with \ref drawString
+             *
+             * @param string String to draw
+             * @param monospace Draw string in monospace font
+             * @param x X pos
+             * @param y Y pos
+             * @param fontSize Height of the text drawn in pixels
+             * @param color Text color
+             * @return Dimensions of drawn string
+             */
+            std::pair<u32, u32> drawCachedString(const std::string &string, bool monospace, s32 x, s32 y, float fontSize, Color color) {
+                const u32 cachedFontSize = std::max(fontSize, 0.0F) * GlyphCache::SizeSubdivisions + 0.5F;
+                const u64 key = std::hash<std::string>{}(string) * 31 + GlyphCache::makeKey(0, monospace, cachedFontSize);
+
+                const TextSpriteCache::Sprite *sprite = this->m_textSprites.find(key, string);
+                if (sprite == nullptr)
+                    sprite = this->buildTextSprite(key, string, monospace, fontSize);
+
+                if (sprite == nullptr || !sprite->drawable)
+                    return this->drawString(string.c_str(), monospace, x, y, fontSize, color);
+
+                if (sprite->glyph.glyphBmp != nullptr && color.a != 0x0) {
+                    const s32 spriteX = x + sprite->offsetX;
+                    const s32 spriteY = y + sprite->offsetY;
+
+                    s32 x0 = spriteX, y0 = spriteY, x1 = spriteX + sprite->glyph.width, y1 = spriteY + sprite->glyph.height;
+                    if (this->clipRect(x0, y0, x1, y1)) {
+                        const auto type = sprite->glyph.runs != nullptr ? DrawCommand::Type::Glyph : DrawCommand::Type::Coverage;
+                        this->submit({ .type = type, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .color = color,
+                                       .data = sprite->glyph.glyphBmp, .dataX = spriteX, .dataY = spriteY, .dataStride = sprite->glyph.stride,
+                                       .alphaTable = Renderer::CoverageTable[color.a], .glyph = &sprite->glyph });
+                    }
+                }
+
+                return sprite->dimensions;
+            }
+
+            /**
+             * @brief Calculates the dimensions of a string without drawing it
+             * @note Same result as \ref drawString with a transparent color, but no glyph ever gets rasterized. Results are cached per string and font size
+             *
+             * @param string String to measure
+             * @param monospace Measure string in monospace font
+             * @param fontSize Height of the text in pixels
+             * @return Dimensions of the string
+             */
+            std::pair<u32, u32> measureString(const std::string &string, bool monospace, float fontSize) {
+                const u32 cachedFontSize = std::max(fontSize, 0.0F) * GlyphCache::SizeSubdivisions + 0.5F;
+                const u64 key = std::hash<std::string>{}(string) * 31 + GlyphCache::makeKey(0, monospace, cachedFontSize);
+
+                if (auto it = this->m_stringMetrics.find(key); it != this->m_stringMetrics.end() && it->second.text == string)
+                    return it->second.dimensions;
+
+                s32 maxPen = 0;
+                s32 currPen = 0;
+                s32 currY = 0;
+
+                Utf8Reader reader(string.c_str(), string.size());
+                const auto &asciiAdvances = this->getAsciiAdvances(monospace, cachedFontSize);
+
+                u32 currCharacter;
+                while (reader.next(currCharacter) > 0) {
+                    if (currCharacter == '\n') {
+                        maxPen = std::max(currPen, maxPen);
+
+                        currPen = 0;
+                        currY += fontSize;
+
+                        continue;
+                    }
+
+                    currPen += currCharacter < 0x80 ? asciiAdvances[currCharacter] : this->getGlyphAdvance(currCharacter, monospace, cachedFontSize);
+                }
+
+                maxPen = std::max(currPen, maxPen);
+
+                if (this->m_stringMetrics.size() >= MaxCachedStringMetrics)
+                    this->m_stringMetrics.clear();
+
+                auto &metrics = this->m_stringMetrics[key];
+                metrics = { .text = string, .dimensions = { penToPixels(maxPen), currY } };
+
+                return metrics.dimensions;
+            }
+
+            /**
+             * @brief Limit a strings length and end it with "…"
+             * @note Where the string can be cut is cached per string and font size, finding the cut is a binary search
+             *
+             * @param string String to truncate
+             * @param maxLength Maximum length of string
+             */
+            std::string limitStringLength(std::string string, bool monospace, float fontSize, s32 maxLength) {
+                if (string.size() < 2)
+                    return string;
+
+                const auto &cutPoints = this->getCutPoints(string, monospace, fontSize);
+
+                // The string gets cut in front of the first character reaching maxLength
+                auto it = std::lower_bound(cutPoints.widths.begin(), cutPoints.widths.end(), maxLength);
+                const size_t cut = std::min<size_t>(it != cutPoints.widths.end() ? cutPoints.starts[it - cutPoints.widths.begin()] : cutPoints.endCut, string.size());
+
+                string = string.substr(0, cut) + "…";
+                string.shrink_to_fit();
+
+                return string;
+            }
+
+            /**
+             * @brief Gets the part of a pixel's offset into the swizzled framebuffer that only depends on its x coordinate
+             *
+             * @param x X pos
+             * @return Offset
+             */
+            static constexpr u32 getSwizzledOffsetX(u32 x) {
+                u32 tmpPos = (x / 32 * 8) * 16 * 16 * 4;
+                tmpPos += ((x % 32) / 16) * 256 + ((x % 16) / 8) * 32 + (x % 8) * 2;
+
+                return tmpPos / 2;
+            }
+
+            /**
+             * @brief Gets the part of a pixel's offset into the swizzled framebuffer that only depends on its y coordinate
+             *
+             * @param y Y pos
+             * @param framebufferWidth Width of the framebuffer
+             * @return Offset
+             */
+            static constexpr u32 getSwizzledOffsetY(u32 y, u32 framebufferWidth) {
+                u32 tmpPos = ((y & 127) / 16) + ((y / 16 / 8) * (((framebufferWidth / 2) / 16 * 8)));
+                tmpPos *= 16 * 16 * 4;
+                tmpPos += ((y % 16) / 8) * 512 + ((y % 8) / 2) * 64 + (y % 2) * 16;
+
+                return tmpPos / 2;
+            }
+
+            /**
+             * @brief Checks that the per-axis offsets add up to the original block-linear address of every pixel of a framebuffer
+             *
+             * @param framebufferWidth Width of the framebuffer
+             * @param framebufferHeight Height of the framebuffer
+             * @return Whether all offsets match
+             */
+            static constexpr bool checkSwizzledOffsets(u32 framebufferWidth, u32 framebufferHeight) {
+                for (u32 y = 0; y < framebufferHeight; y++) {
+                    for (u32 x = 0; x < framebufferWidth; x++) {
+                        u32 tmpPos = ((y & 127) / 16) + (x / 32 * 8) + ((y / 16 / 8) * (((framebufferWidth / 2) / 16 * 8)));
+                        tmpPos *= 16 * 16 * 4;
+
+                        tmpPos += ((y % 16) / 8) * 512 + ((x % 32) / 16) * 256 + ((y % 8) / 2) * 64 + ((x % 16) / 8) * 32 + (y % 2) * 16 + (x % 8) * 2;
+
+                        if (getSwizzledOffsetX(x) + getSwizzledOffsetY(y, framebufferWidth) != tmpPos / 2)
+                            return false;
+                    }
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Checks the blending tables against the float math they replaced, for every input
+             * @note Opacity tables are checked for every opacity in steps of 1% and for each step of the fade-in
+             *
+             * @return Whether all entries match
+             */
+            static constexpr bool checkBlendTables() {
+                for (u8 alpha = 0; alpha < 16; alpha++) {
+                    for (u8 src = 0; src < 16; src++) {
+                        for (u8 dst = 0; dst < 16; dst++) {
+                            const u8 blended = (dst * alpha + src * (0x0F - alpha)) / float(0xF);
+                            if (BlendTable[alpha][src][dst] != blended)
+                                return false;
+                        }
+                    }
+
+                    for (u8 coverage = 0; coverage < 16; coverage++) {
+                        const u8 opacity = coverage * (float(alpha) / 0xF);
+                        if (CoverageTable[alpha][coverage] != opacity)
+                            return false;
+                    }
+                }
+
+                auto checkOpacity = [](float opacity) {
+                    const LevelTable table = makeOpacityTable(opacity);
+
+                    for (u8 alpha = 0; alpha < 16; alpha++) {
+                        const Color color = { 0x0, 0x0, 0x0, alpha };
+                        if (table[alpha] != static_cast<u8>(color.a * opacity))
+                            return false;
+                    }
+
+                    return true;
+                };
+
+                for (u32 percent = 0; percent <= 100; percent++)
+                    if (!checkOpacity(percent / 100.0F))
+                        return false;
+
+                for (u32 step = 0; step <= 5; step++)
+                    if (!checkOpacity(0.2 * step))
+                        return false;
+
+                return true;
+            }
+
+        private:
+            Renderer() {}
+
+            static constexpr size_t MaxCachedStringMetrics = 256;
+            static constexpr size_t MaxCachedAdvances = 4096;
+            static constexpr size_t MaxCachedAsciiAdvances = 32;       ///< Font sizes to keep ASCII advance tables of
+            static constexpr size_t MaxCachedCutPointsBytes = 256 * 1024;
+            static constexpr u32 PenFractionBits = 6;
+            static constexpr s32 PenSubdivisions = 1 << PenFractionBits;   ///< Pen positions and advances are kept in steps of 1/64 pixel
+
+            using AsciiAdvances = std::array<s32, 0x80>;
+
+            /**
+             * @brief Cached dimensions of a string
+             */
+            struct StringMetrics {
+                std::string text;                       ///< String measured, in case two strings share a key
+                std::pair<u32, u32> dimensions;
+            };
+
+            /**
+             * @brief Places a string can get truncated at
+             */
+            struct CutPoints {
+                std::string text;               ///< String the cut points are of, in case two strings share a key
+                std::vector<u32> starts;        ///< Byte offset of each character
+                std::vector<s32> widths;        ///< Width of the string up to and including each character
+                size_t endCut;                  ///< Where to cut if no character reaches the maximum length
+            };
+
+            static constexpr u32 GlyphIndexPageSize = 256;      ///< Codepoints per page of the glyph index
+
+            static constexpr const char *GlyphAtlasPath = "/config/tesla/glyph_atlas.bin";
+            static constexpr const char *GlyphAtlasTempPath = "/config/tesla/glyph_atlas.tmp";
+            static constexpr u32 GlyphAtlasMagic = 0x414C4754;         ///< "TGLA"
+            static constexpr u32 GlyphAtlasVersion = 1;                 ///< Has to change whenever the file layout or the way glyphs get rasterized changes
+            static constexpr s64 MaxGlyphAtlasFileSize = 4 * 1024 * 1024;
+            static constexpr u64 GlyphAtlasSaveIntervalNs = 5'000'000'000;
+
+            /**
+             * @brief Start of the persistent glyph atlas file, followed by a \ref GlyphAtlasRecord and the packed coverage rows of each glyph
+             */
+            struct GlyphAtlasHeader {
+                u32 magic;
+                u32 version;
+                u64 fontIdentity;           ///< See \ref getFontIdentity
+                u32 glyphCount;
+                u32 reserved;
+            };
+
+            struct GlyphAtlasRecord {
+                u64 key;
+                float scale;
+                s32 bounds[4];
+                s32 xAdvance;
+                u16 width, height;
+                u8 fontSlot;
+                u8 reserved[3];
+            };
+
+            enum class FontSlot : u8 {
+                Standard,
+                Local,
+                Extended
+            };
+
+            /**
+             * @brief Font and glyph a codepoint gets drawn with
+             */
+            struct GlyphLocation {
+                stbtt_fontinfo *font;
+                int glyph;                  ///< Glyph index within the font
+                int monospaceGlyph;         ///< Glyph whose advance monospace text uses
+            };
+
+            /**
+             * @brief How far glyphs of any loaded font can reach from the pen, per pixel of font size
+             * @note Taken from the fonts' bounding boxes, so they hold for every glyph without rasterizing any
+             */
+            struct GlyphExtents {
+                float left, right;          ///< Furthest any glyph reaches left and right of the pen position
+                float top, bottom;          ///< Furthest any glyph reaches above and below the baseline
+            };
+
+            /**
+             * @brief Picks the font to draw a character with by searching the fonts' character maps
+             *
+             * @param codepoint Unicode codepoint
+             * @return Font slot in the upper and glyph index in the lower 16 bit
+             */
+            u32 findGlyph(u32 codepoint) {
+                if (int glyph = stbtt_FindGlyphIndex(&this->m_extFont, codepoint); glyph != 0)
+                    return static_cast<u32>(FontSlot::Extended) << 16 | glyph;
+                else if (this->m_hasLocalFont && stbtt_FindGlyphIndex(&this->m_stdFont, codepoint) == 0)
+                    return static_cast<u32>(FontSlot::Local) << 16 | stbtt_FindGlyphIndex(&this->m_localFont, codepoint);
+                else
+                    return static_cast<u32>(FontSlot::Standard) << 16 | stbtt_FindGlyphIndex(&this->m_stdFont, codepoint);
+            }
+
+            /**
+             * @brief Looks up the font and glyph a codepoint gets drawn with
+             * @note Codepoints of the basic multilingual plane go through a two-level index. Each page gets filled the first time one of its codepoints is used
+             *
+             * @param codepoint Unicode codepoint
+             * @return Glyph location
+             */
+            GlyphLocation lookupGlyph(u32 codepoint) {
+                u32 entry;
+
+                if (codepoint < 0x10000) {
+                    auto &page = this->m_glyphIndex[codepoint / GlyphIndexPageSize];
+
+                    if (page == nullptr) {
+                        page = std::make_unique<u32[]>(GlyphIndexPageSize);
+
+                        const u32 firstCodepoint = codepoint & ~(GlyphIndexPageSize - 1);
+                        for (u32 i = 0; i < GlyphIndexPageSize; i++)
+                            page[i] = this->findGlyph(firstCodepoint + i);
+                    }
+
+                    entry = page[codepoint % GlyphIndexPageSize];
+                } else {
+                    entry = this->findGlyph(codepoint);
+                }
+
+                const u8 slot = entry >> 16;
+                stbtt_fontinfo *fonts[] = { &this->m_stdFont, &this->m_localFont, &this->m_extFont };
+
+                return { fonts[slot], static_cast<int>(entry & 0xFFFF), this->m_monospaceGlyphs[slot] };
+            }
+
+            /**
+             * @brief Rasterizes a glyph right away and adds it to the cache, counting the time taken against the frame's rasterization budget
+             *
+             * @param key Glyph key
+             * @param location Font and glyph to rasterize
+             * @param monospace Use monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @param phase Subpixel phase, see \ref GlyphCache::makeKey
+             * @return Cached glyph
+             */
+            GlyphCache::Glyph* cacheGlyph(u64 key, const GlyphLocation &location, bool monospace, u32 fontSize, u8 phase) {
+                const u64 startTick = armGetSystemTick();
+
+                GlyphCache::Glyph newGlyph = {};
+                rasterizeGlyph(location, monospace, fontSize, phase, newGlyph, this->m_glyphScratch);
+
+                GlyphCache::Glyph *glyph = this->m_glyphCache.insert(key, newGlyph, this->m_glyphScratch.data());
+
+                this->m_glyphRasterizationTicks += armGetSystemTick() - startTick;
+
+                return glyph;
+            }
+
+            /**
+             * @brief Renders a whole string into a sprite and adds it to the text sprite cache
+             * @note Glyphs get placed exactly like \ref drawString places them. Where glyphs overlap, their coverage gets combined the way blending them one after another would
+             *
+             * @param key Sprite key
+             * @param string String
+             * @param monospace Use monospace advances
+             * @param fontSize Height of the text in pixels
+             * @return Sprite, nullptr if not all glyphs could be rasterized within this frame's budget
+             */
+            const TextSpriteCache::Sprite* buildTextSprite(u64 key, const std::string &string, bool monospace, float fontSize) {
+                struct PlacedGlyph {
+                    s32 x, y;
+                    const GlyphCache::Glyph *glyph;
+                };
+
+                const u32 cachedFontSize = std::max(fontSize, 0.0F) * GlyphCache::SizeSubdivisions + 0.5F;
+
+                std::vector<PlacedGlyph> placedGlyphs;
+                s32 maxPen = 0, currPen = 0, currY = 0;
+                s32 left = INT32_MAX, top = INT32_MAX, right = INT32_MIN, bottom = INT32_MIN;
+
+                const char *curr = string.c_str();
+                while (*curr != '\0') {
+                    u32 currCharacter;
+                    ssize_t codepointWidth = decode_utf8(&currCharacter, reinterpret_cast<const u8*>(curr));
+
+                    if (codepointWidth <= 0)
+                        break;
+
+                    curr += codepointWidth;
+
+                    if (currCharacter == '\n') {
+                        maxPen = std::max(currPen, maxPen);
+
+                        currPen = 0;
+                        currY += fontSize;
+
+                        continue;
+                    }
+
+                    u8 phase;
+                    const s32 penX = snapPen(currPen, phase);
+                    const u64 glyphKey = GlyphCache::makeKey(currCharacter, monospace, cachedFontSize, phase);
+
+                    GlyphCache::Glyph *glyph = this->m_glyphCache.find(glyphKey);
+                    if (glyph == nullptr) {
+                        if (this->m_queuedGlyphs.contains(glyphKey) || armTicksToNs(this->m_glyphRasterizationTicks) >= Renderer::s_glyphRasterizationBudgetNs)
+                            return nullptr;
+
+                        glyph = this->cacheGlyph(glyphKey, this->lookupGlyph(currCharacter), monospace, cachedFontSize, phase);
+                    }
+
+                    if (glyph->glyphBmp != nullptr && !std::iswspace(currCharacter) && fontSize > 0) {
+                        const s32 glyphX = penX + glyph->bounds[0], glyphY = currY + glyph->bounds[1];
+
+                        placedGlyphs.push_back({ glyphX, glyphY, glyph });
+
+                        left = std::min(left, glyphX);
+                        top = std::min(top, glyphY);
+                        right = std::max(right, glyphX + glyph->width);
+                        bottom = std::max(bottom, glyphY + glyph->height);
+                    }
+
+                    currPen += toPenAdvance(glyph->xAdvance, glyph->currFontSize);
+                }
+
+                maxPen = std::max(currPen, maxPen);
+
+                TextSpriteCache::Sprite sprite = { .offsetX = 0, .offsetY = 0, .dimensions = { penToPixels(maxPen), currY }, .drawable = true, .glyph = {} };
+                std::unique_ptr<u8[]> coverage, runs;
+                size_t runsSize = 0;
+
+                if (!placedGlyphs.empty()) {
+                    const s32 width = right - left, height = bottom - top;
+
+                    if (width * height > TextSpriteCache::MaxPixels) {
+                        sprite.drawable = false;
+                    } else {
+                        const s32 stride = (width + 1) / 2;
+                        coverage = std::make_unique<u8[]>(stride * height + TextSpriteCache::Padding);
+
+                        auto getLevel = [&](const u8 *data, s32 dataStride, s32 x, s32 y) -> u8 {
+                            return (data[y * dataStride + x / 2] >> ((x & 1) * 4)) & 0xF;
+                        };
+
+                        for (const auto &placed : placedGlyphs) {
+                            for (s32 y = 0; y < placed.glyph->height; y++) {
+                                for (s32 x = 0; x < placed.glyph->width; x++) {
+                                    const u8 level = getLevel(placed.glyph->glyphBmp, placed.glyph->stride, x, y);
+                                    if (level == 0x0)
+                                        continue;
+
+                                    const s32 spriteX = placed.x - left + x, spriteY = placed.y - top + y;
+                                    u8 &packed = coverage[spriteY * stride + spriteX / 2];
+                                    const u8 shift = (spriteX & 1) * 4;
+                                    const u8 dst = (packed >> shift) & 0xF;
+
+                                    packed = (packed & ~(0xF << shift)) | ((dst + level - (dst * level + 7) / 15) << shift);
+                                }
+                            }
+                        }
+
+                        runsSize = GlyphCache::buildRuns(width, height, [&](s32 x, s32 y) { return getLevel(coverage.get(), stride, x, y); }, runs);
+
+                        sprite.offsetX = left;
+                        sprite.offsetY = top;
+                        sprite.glyph.width = width;
+                        sprite.glyph.height = height;
+                        sprite.glyph.stride = stride;
+                    }
+                }
+
+                return this->m_textSprites.insert(key, string, sprite, std::move(coverage), std::move(runs), runsSize);
+            }
+
+            /**
+             * @brief Stands in for a glyph that's still being rasterized. Nothing gets drawn, but its area gets repainted once the glyph is ready
+             *
+             * @param location Font and glyph
+             * @param fontSize Font size in 1/64 pixels
+             * @param phase Subpixel phase, see \ref GlyphCache::makeKey
+             * @param x X pos of the pen
+             * @param y Y pos of the baseline
+             */
+            void drawGlyphPlaceholder(const GlyphLocation &location, u32 fontSize, u8 phase, s32 x, s32 y) {
+                const float scale = stbtt_ScaleForPixelHeight(location.font, static_cast<float>(fontSize) / GlyphCache::SizeSubdivisions);
+                const float shift = static_cast<float>(phase) / GlyphCache::MaxSubpixelPhases;
+
+                int bounds[4];
+                stbtt_GetGlyphBitmapBoxSubpixel(location.font, location.glyph, scale, scale, shift, 0, &bounds[0], &bounds[1], &bounds[2], &bounds[3]);
+
+                s32 x0 = x + bounds[0], y0 = y + bounds[1], x1 = x + bounds[2], y1 = y + bounds[3];
+                if (this->clipRect(x0, y0, x1, y1))
+                    this->m_placeholderAreas.push_back({ x0, y0, x1 - x0, y1 - y0 });
+            }
+
+            /**
+             * @brief Rasterizes a glyph
+             * @note Only reads the font, so it's safe to call from other threads as long as the fonts stay loaded
+             *
+             * @param location Font and glyph to rasterize
+             * @param monospace Use monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @param phase Subpixel phase to shift the glyph right by, see \ref GlyphCache::makeKey
+             * @param glyph Glyph to fill in, apart from the coverage pointers set by \ref GlyphCache::insert
+             * @param coverage Receives the 8 bit coverage of the glyph, one byte per pixel without padding
+             */
+            static void rasterizeGlyph(const GlyphLocation &location, bool monospace, u32 fontSize, u8 phase, GlyphCache::Glyph &glyph, std::vector<u8> &coverage) {
+                const float shift = static_cast<float>(phase) / GlyphCache::MaxSubpixelPhases;
+
+                glyph.currFont = location.font;
+                glyph.currFontSize = stbtt_ScaleForPixelHeight(glyph.currFont, static_cast<float>(fontSize) / GlyphCache::SizeSubdivisions);
+
+                stbtt_GetGlyphBitmapBoxSubpixel(glyph.currFont, location.glyph, glyph.currFontSize, glyph.currFontSize,
+                                                shift, 0, &glyph.bounds[0], &glyph.bounds[1], &glyph.bounds[2], &glyph.bounds[3]);
+
+                int yAdvance = 0;
+                stbtt_GetGlyphHMetrics(glyph.currFont, monospace ? location.monospaceGlyph : location.glyph, &glyph.xAdvance, &yAdvance);
+
+                glyph.width = glyph.bounds[2] - glyph.bounds[0];
+                glyph.height = glyph.bounds[3] - glyph.bounds[1];
+
+                coverage.assign(std::max(glyph.width * glyph.height, 0), 0);
+                stbtt_MakeGlyphBitmapSubpixel(glyph.currFont, coverage.data(), glyph.width, glyph.height, glyph.width, glyph.currFontSize, glyph.currFontSize, shift, 0, location.glyph);
+            }
+
+            /**
+             * @brief Resets the glyph index after the fonts got loaded
+             * @note The page holding Basic Latin and Latin-1 gets filled right away
+             */
+            void initGlyphIndex() {
+                for (auto &page : this->m_glyphIndex)
+                    page.reset();
+
+                this->m_monospaceGlyphs[static_cast<u8>(FontSlot::Standard)] = stbtt_FindGlyphIndex(&this->m_stdFont, 'W');
+                this->m_monospaceGlyphs[static_cast<u8>(FontSlot::Local)] = this->m_hasLocalFont ? stbtt_FindGlyphIndex(&this->m_localFont, 'W') : 0;
+                this->m_monospaceGlyphs[static_cast<u8>(FontSlot::Extended)] = stbtt_FindGlyphIndex(&this->m_extFont, 'W');
+
+                this->m_glyphExtents = {};
+                for (auto font : { &this->m_stdFont, &this->m_localFont, &this->m_extFont }) {
+                    if (font == &this->m_localFont && !this->m_hasLocalFont)
+                        continue;
+
+                    int x0, y0, x1, y1;
+                    stbtt_GetFontBoundingBox(font, &x0, &y0, &x1, &y1);
+
+                    const float scale = stbtt_ScaleForPixelHeight(font, 1.0F);
+                    this->m_glyphExtents.left   = std::max(this->m_glyphExtents.left, -x0 * scale);
+                    this->m_glyphExtents.right  = std::max(this->m_glyphExtents.right, x1 * scale);
+                    this->m_glyphExtents.top    = std::max(this->m_glyphExtents.top, y1 * scale);
+                    this->m_glyphExtents.bottom = std::max(this->m_glyphExtents.bottom, -y0 * scale);
+                }
+
+                this->lookupGlyph(0);
+            }
+
+            /**
+             * @brief Gets the places a string can get truncated at, up to its end or first line break
+             *
+             * @param string String
+             * @param monospace Measure string in monospace font
+             * @param fontSize Height of the text in pixels
+             * @return Cut points
+             */
+            const CutPoints& getCutPoints(const std::string &string, bool monospace, float fontSize) {
+                const u32 cachedFontSize = std::max(fontSize, 0.0F) * GlyphCache::SizeSubdivisions + 0.5F;
+                const u64 key = std::hash<std::string>{}(string) * 31 + GlyphCache::makeKey(0, monospace, cachedFontSize);
+
+                if (auto it = this->m_cutPoints.find(key); it != this->m_cutPoints.end() && it->second.text == string)
+                    return it->second;
+
+                CutPoints cutPoints;
+                cutPoints.text = string;
+                s32 currPen = 0;
+                size_t strPos = 0;
+
+                Utf8Reader reader(string.c_str(), string.size());
+                const auto &asciiAdvances = this->getAsciiAdvances(monospace, cachedFontSize);
+
+                do {
+                    u32 currCharacter;
+                    const ssize_t codepointWidth = reader.next(currCharacter);
+
+                    if (codepointWidth <= 0) {
+                        cutPoints.endCut = strPos - codepointWidth;
+                        break;
+                    }
+
+                    currPen += currCharacter < 0x80 ? asciiAdvances[currCharacter] : this->getGlyphAdvance(currCharacter, monospace, cachedFontSize);
+
+                    cutPoints.starts.push_back(strPos);
+                    cutPoints.widths.push_back(penToPixels(currPen));
+                    cutPoints.endCut = strPos;
+
+                    strPos += codepointWidth;
+                } while (string[strPos] != '\0' && string[strPos] != '\n');
+
+                const auto getSize = [](const CutPoints &points) {
+                    return points.starts.size() * (sizeof(u32) + sizeof(s32)) + points.text.capacity() + sizeof(CutPoints);
+                };
+
+                // A different string with the same key gets replaced
+                if (auto it = this->m_cutPoints.find(key); it != this->m_cutPoints.end()) {
+                    this->m_cutPointsBytes -= getSize(it->second);
+                    this->m_cutPoints.erase(it);
+                }
+
+                const size_t size = getSize(cutPoints);
+                if (this->m_cutPointsBytes + size > MaxCachedCutPointsBytes) {
+                    this->m_cutPoints.clear();
+                    this->m_cutPointsBytes = 0;
+                }
+
+                this->m_cutPointsBytes += size;
+
+                return this->m_cutPoints[key] = std::move(cutPoints);
+            }
+
+            /**
+             * @brief Gets how far the pen moves after a glyph, without rasterizing it
+             *
+             * @param codepoint Unicode codepoint
+             * @param monospace Use monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @return Advance in 1/\ref PenSubdivisions pixels
+             */
+            s32 getGlyphAdvance(u32 codepoint, bool monospace, u32 fontSize) {
+                const u64 key = GlyphCache::makeKey(codepoint, monospace, fontSize);
+
+                if (auto it = this->m_glyphAdvances.find(key); it != this->m_glyphAdvances.end())
+                    return it->second;
+
+                if (this->m_glyphAdvances.size() >= MaxCachedAdvances)
+                    this->m_glyphAdvances.clear();
+
+                return this->m_glyphAdvances[key] = this->measureGlyphAdvance(codepoint, monospace, fontSize);
+            }
+
+            /**
+             * @brief Gets the advances of all ASCII characters at once, see \ref getGlyphAdvance
+             *
+             * @param monospace Use monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @return Advance of each character in 1/\ref PenSubdivisions pixels
+             */
+            const AsciiAdvances& getAsciiAdvances(bool monospace, u32 fontSize) {
+                const u64 key = GlyphCache::makeKey(0, monospace, fontSize);
+
+                if (auto it = this->m_asciiAdvances.find(key); it != this->m_asciiAdvances.end())
+                    return it->second;
+
+                if (this->m_asciiAdvances.size() >= MaxCachedAsciiAdvances)
+                    this->m_asciiAdvances.clear();
+
+                auto &advances = this->m_asciiAdvances[key];
+                for (u32 character = 0; character < advances.size(); character++)
+                    advances[character] = this->measureGlyphAdvance(character, monospace, fontSize);
+
+                return advances;
+            }
+
+            /**
+             * @brief Reads how far the pen moves after a glyph from the font
+             *
+             * @param codepoint Unicode codepoint
+             * @param monospace Use monospace advances
+             * @param fontSize Font size in 1/64 pixels
+             * @return Advance in 1/\ref PenSubdivisions pixels
+             */
+            s32 measureGlyphAdvance(u32 codepoint, bool monospace, u32 fontSize) {
+                const GlyphLocation location = this->lookupGlyph(codepoint);
+                const float scale = stbtt_ScaleForPixelHeight(location.font, static_cast<float>(fontSize) / GlyphCache::SizeSubdivisions);
+
+                int xAdvance = 0, yAdvance = 0;
+                stbtt_GetGlyphHMetrics(location.font, monospace ? location.monospaceGlyph : location.glyph, &xAdvance, &yAdvance);
+
+                return toPenAdvance(xAdvance, scale);
+            }
+
+            /**
+             * @brief Converts a glyph's advance to pen units
+             *
+             * @param xAdvance Advance in font units
+             * @param scale Font scale
+             * @return Advance in 1/\ref PenSubdivisions pixels
+             */
+            static ALWAYS_INLINE s32 toPenAdvance(int xAdvance, float scale) {
+                return static_cast<s32>(xAdvance * scale * PenSubdivisions + 0.5F);
+            }
+
+            /**
+             * @brief Converts a distance the pen moved to whole pixels, rounding up so text always fits the returned size
+             *
+             * @param pen Distance in 1/\ref PenSubdivisions pixels
+             * @return Distance in pixels
+             */
+            static ALWAYS_INLINE s32 penToPixels(s32 pen) {
+                return (pen + PenSubdivisions - 1) >> PenFractionBits;
+            }
+
+            /**
+             * @brief Splits a pen position into the pixel a glyph gets drawn at and the subpixel phase closest to the rest
+             *
+             * @param pen Pen position in 1/\ref PenSubdivisions pixels
+             * @param phase Receives the phase, see \ref GlyphCache::makeKey
+             * @return Pen position in pixels the glyph gets drawn at
+             */
+            static ALWAYS_INLINE s32 snapPen(s32 pen, u8 &phase) {
+                const u32 phaseBits = Renderer::s_subpixelPhaseBits;
+                const s32 snapped = (pen + (PenSubdivisions >> (phaseBits + 1))) >> (PenFractionBits - phaseBits);
+
+                phase = (snapped & ((1 << phaseBits) - 1)) << (std::countr_zero(GlyphCache::MaxSubpixelPhases) - phaseBits);
+
+                return snapped >> phaseBits;
+            }
+
+            /**
+             * @brief Gets the renderer instance
+             *
+             * @return Renderer
+             */
+            static Renderer& get() {
+                static Renderer renderer;
+
+                return renderer;
+            }
+
+        public:
+            /**
+             * @brief Enables or disables damage tracking
+             * @note With damage tracking enabled, only the areas reported through \ref addDamage since a framebuffer was last drawn to get repainted.
+             *       Frames without any reported changes are skipped entirely.
+             *       All elements that change their look need to report it, e.g using \ref elm::Element::markDirty()
+             *
+             * @param enabled Enabled
+             */
+            static void setDamageTracking(bool enabled) {
+                Renderer::s_damageTracking = enabled;
+
+                Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+            }
+
+            /**
+             * @brief Enables or disables recording mode
+             * @note In recording mode draw calls get recorded instead of drawn right away. At the end of the frame they're sorted into tiles
+             *       and each tile gets drawn with all its commands at once, keeping that part of the framebuffer in cache.
+             *       Bitmaps passed to \ref drawBitmap and textures passed to \ref drawTexture need to stay valid until the frame ends
+             *
+             * @param enabled Enabled
+             */
+            static void setRecording(bool enabled) {
+                Renderer::s_recordingEnabled = enabled;
+            }
+
+            /**
+             * @brief Sets the number of threads drawing recorded frames
+             * @note Only used in recording mode. Defaults to 1. The thread ending the frame is one of them, the others get started when first needed,
+             *       each on a core of the process's core mask other than the current one. Without any such cores frames are drawn on a single thread
+             *
+             * @param count Number of threads, 1 to 4
+             */
+            static void setRasterizerThreadCount(u32 count) {
+                Renderer::s_rasterizerThreadCount = std::clamp<u32>(count, 1, MaxRasterizerThreads);
+            }
+
+            /**
+             * @brief Sets how much memory the glyph cache may keep between frames
+             * @note The cache may grow past the budget while a frame is being drawn, least recently used glyphs get dropped when it ends
+             *
+             * @param bytes Budget in bytes
+             */
+            static void setGlyphCacheBudget(size_t bytes) {
+                Renderer::s_glyphCacheBudget = bytes;
+            }
+
+            /**
+             * @brief Sets the glyphs rasterized in the background while waiting for the overlay to get opened the first time
+             * @note Defaults to ASCII and the button glyphs in the font sizes used by the built-in elements.
+             *       Has to be called before the renderer gets initialized, e.g. from the overlay's constructor. Pass an empty set to disable pre-warming
+             *
+             * @param set Glyph set
+             */
+            static void setGlyphPrewarmSet(GlyphPrewarmSet set) {
+                Renderer::get().m_glyphPrewarmSet = std::move(set);
+            }
+
+            /**
+             * @brief Sets how much memory the text sprite cache used by \ref drawCachedString may keep between frames
+             *
+             * @param bytes Budget in bytes
+             */
+            static void setTextSpriteCacheBudget(size_t bytes) {
+                Renderer::s_textSpriteCacheBudget = bytes;
+            }
+
+            /**
+             * @brief Sets how much time each frame may spend rasterizing glyphs before the rest gets rasterized in the background
+             * @note Glyphs rasterized in the background show up a frame or more later, until then nothing gets drawn in their place
+             *
+             * @param ns Budget in nanoseconds. 0 rasterizes all uncached glyphs in the background, UINT64_MAX none of them
+             */
+            static void setGlyphRasterizationBudget(u64 ns) {
+                Renderer::s_glyphRasterizationBudgetNs = ns;
+            }
+
+            /**
+             * @brief Sets at how many horizontal subpixel positions glyphs get rasterized
+             * @note Text gets laid out with fractional advances either way. More phases place each glyph closer to its exact position,
+             *       but every phase of a glyph takes up its own space in the glyph cache. 1 snaps glyphs to whole pixels. Defaults to 2.
+             *       The default pre-warm set takes up about 150 KB with 1 phase, 300 KB with 2 and 470 KB with 4, so more than 2 need a bigger \ref setGlyphCacheBudget.
+             *       Must not be called while a frame is being drawn, recorded draw commands may still point into the text sprites it drops
+             *
+             * @param phases Number of phases, rounded down to a power of two up to \ref GlyphCache::MaxSubpixelPhases
+             */
+            static void setSubpixelPhases(u8 phases) {
+                assert(Renderer::get().m_currentFramebuffer == nullptr);
+
+                Renderer::s_subpixelPhaseBits = std::countr_zero(std::bit_floor(std::clamp<u8>(phases, 1, GlyphCache::MaxSubpixelPhases)));
+
+                // Text sprites have their glyphs' phases baked in
+                Renderer::get().m_textSprites.trim();
+                Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+            }
+
+            /**
+             * @brief Enables or disables keeping the glyph cache on the SD card between overlay launches
+             * @note The cache gets loaded when the renderer gets initialized and written back in the background every few seconds while new glyphs get added.
+             *       It's only reused as long as the system fonts and \ref GlyphAtlasVersion stay the same.
+             *       Has to be called before the renderer gets initialized, e.g. from the overlay's constructor
+             *
+             * @param enabled Enabled
+             */
+            static void setPersistentGlyphAtlas(bool enabled) {
+                Renderer::s_persistentGlyphAtlas = enabled;
+            }
+
+            /**
+             * @brief Drops all cached glyphs and text sprites, e.g. while the overlay is hidden
+             * @note Must not be called while a frame is being drawn
+             */
+            static void trimGlyphCache() {
+                Renderer::get().m_textSprites.trim();
+                Renderer::get().m_glyphCache.trim();
+            }
+
+            /**
+             * @brief Reports an area that changed and has to be repainted in every framebuffer
+             * @note Areas reported while a frame is being drawn get repainted starting with the next frame
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param w Width
+             * @param h Height
+             */
+            void addDamage(s32 x, s32 y, s32 w, s32 h) {
+                const s32 x0 = std::max(x, 0);
+                const s32 y0 = std::max(y, 0);
+                const s32 x1 = std::min(x + w, static_cast<s32>(cfg::FramebufferWidth));
+                const s32 y1 = std::min(y + h, static_cast<s32>(cfg::FramebufferHeight));
+
+                if (x0 >= x1 || y0 >= y1)
+                    return;
+
+                // Every framebuffer keeps the bounding box of everything that changed since it was last drawn to
+                for (auto &damage : this->m_framebufferDamage) {
+                    if (damage.w <= 0 || damage.h <= 0) {
+                        damage = { x0, y0, x1 - x0, y1 - y0 };
+                    } else {
+                        const s32 damageX1 = std::max(damage.x + damage.w, x1);
+                        const s32 damageY1 = std::max(damage.y + damage.h, y1);
+
+                        damage.x = std::min(damage.x, x0);
+                        damage.y = std::min(damage.y, y0);
+                        damage.w = damageX1 - damage.x;
+                        damage.h = damageY1 - damage.y;
+                    }
+                }
+            }
+
+            /**
+             * @brief Gets counters about the frames drawn so far
+             *
+             * @return Render stats
+             */
+            inline const RenderStats& getStats() {
+                return this->m_stats;
+            }
+
+            /**
+             * @brief Gets the fraction of the layer that got repainted in the last drawn frame
+             *
+             * @return Value between 0 and 1
+             */
+            inline float getLastRedrawFraction() {
+                return static_cast<float>(this->m_stats.lastRedrawnPixels) / (cfg::FramebufferWidth * cfg::FramebufferHeight);
+            }
+
+            /**
+             * @brief Gets the glyph cache's hit, miss and eviction counters and its memory usage
+             *
+             * @return Glyph cache stats
+             */
+            inline const GlyphCache::Stats& getGlyphCacheStats() {
+                return this->m_glyphCache.getStats();
+            }
+
+        private:
+
+            /**
+             * @brief Sets the opacity of the layer
+             *
+             * @param opacity Opacity
+             */
+            static void setOpacity(float opacity) {
+                opacity = std::clamp(opacity, 0.0F, 1.0F);
+
+                // Every color on screen has the opacity applied
+                if (opacity != Renderer::s_opacity)
+                    Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+
+                Renderer::s_opacity = opacity;
+                Renderer::s_opacityTable = makeOpacityTable(opacity);
+            }
+
+            /**
+             * @brief Builds the table of each alpha level with an opacity applied
+             *
+             * @param opacity Opacity
+             * @return Table
+             */
+            static constexpr LevelTable makeOpacityTable(float opacity) {
+                LevelTable table = {};
+
+                for (u8 i = 0; i < 16; i++)
+                    table[i] = static_cast<u8>(i * opacity);
+
+                return table;
+            }
+
+            bool m_initialized = false;
+            ViDisplay m_display;
+            ViLayer m_layer;
+            Event m_vsyncEvent;
+
+            NWindow m_window;
+            Framebuffer m_framebuffer;
+            void *m_currentFramebuffer = nullptr;
+
+            std::array<ScissoringConfig, 16> m_scissoringStack;
+            size_t m_scissoringDepth = 0;
+
+            /**
+             * @brief A single draw call, already clipped to the scissoring boundaries it was issued with
+             */
+            struct DrawCommand {
+                enum class Type : u8 {
+                    Fill,           ///< Overwrite pixels with the color
+                    BlendDst,       ///< Destination blend the color
+                    BlendSrc,       ///< Source blend the color, keeping the framebuffer's alpha
+                    Coverage,       ///< Draw packed 4 bit coverage data in the color
+                    Glyph,          ///< Draw a cached glyph's coverage run by run in the color
+                    Bitmap,         ///< Source blend RGBA8888 pixel data
+                    Texture         ///< Source blend a texture's visible runs
+                };
+
+                Type type;
+                s32 x0, y0, x1, y1;             ///< Covered area, right and bottom edge exclusive
+                Color color = 0;
+                const u8 *data = nullptr;       ///< Coverage or bitmap data
+                s32 dataX = 0, dataY = 0;       ///< Position of the first pixel of the data
+                s32 dataStride = 0;             ///< Pixels per row of bitmap data, bytes per row of coverage data
+                LevelTable alphaTable = {};     ///< Opacity of each coverage or alpha level of the data
+                const Texture *texture = nullptr;
+                const GlyphCache::Glyph *glyph = nullptr;
+            };
+
+            static constexpr s32 TileWidth = 32, TileHeight = 16;       ///< One block of the swizzled framebuffer, 1KB of contiguous memory
+            static constexpr s32 TilesPerColumn = 128 / TileHeight;     ///< Tiles in one column of blocks
+            static constexpr u32 MaxRasterizerThreads = 4;
+
+            struct RasterizerThread {
+                Thread thread;
+                Renderer *renderer;
+                u32 index;
+            };
+
+            bool m_recording = false;
+            static inline bool s_recordingEnabled = false;
+            std::vector<DrawCommand> m_drawCommands;
+            std::vector<u32> m_tileCommandStarts, m_tileCommands;
+
+            static inline u32 s_rasterizerThreadCount = 1;
+            std::array<RasterizerThread, MaxRasterizerThreads - 1> m_rasterizerThreads;
+            u32 m_rasterizerThreadsStarted = 0;
+            std::array<std::atomic<u32>, MaxRasterizerThreads> m_rasterizerWork;      ///< Columns left for each thread, first one in the lower and one past the last one in the upper 16 bit
+            std::mutex m_rasterizerMutex;
+            std::condition_variable m_rasterizerStart, m_rasterizerDone;
+            u32 m_rasterizerGeneration = 0, m_rasterizerPending = 0;
+            bool m_rasterizerExit = false;
+
+            static constexpr u32 FramebufferCount = 2;
+            std::array<ScissoringConfig, FramebufferCount> m_framebufferDamage = {};
+            ScissoringConfig m_frameDamage = {};
+            RenderStats m_stats;
+            static inline bool s_damageTracking = false;
+            std::vector<u32> m_pixelOffsetsX, m_pixelOffsetsY;
+            std::vector<s32> m_outerHalfWidths, m_innerHalfWidths;
+
+            struct GlyphJob {
+                u64 key;
+                GlyphLocation location;
+                u32 fontSize;               ///< Font size in 1/64 pixels
+                bool monospace;
+                u8 phase;                   ///< Subpixel phase, see \ref GlyphCache::makeKey
+            };
+
+            struct RasterizedGlyph {
+                u64 key;
+                GlyphCache::Glyph glyph;
+                std::vector<u8> coverage;
+            };
+
+            static inline bool s_persistentGlyphAtlas = false;
+            u64 m_glyphAtlasSavedInsertions = 0;        ///< Glyph cache insertions when the atlas file was last loaded or saved
+            u64 m_glyphAtlasSaveTick = 0;
+            Thread m_glyphAtlasWriterThread;
+            bool m_glyphAtlasWriterStarted = false;
+            std::atomic<bool> m_glyphAtlasWriting = false;
+            std::vector<u8> m_glyphAtlasFile;           ///< Only touched by the writer thread while it's running
+
+            GlyphPrewarmSet m_glyphPrewarmSet = getDefaultGlyphPrewarmSet();
+            static inline u64 s_glyphRasterizationBudgetNs = 2'000'000;
+            static inline u8 s_subpixelPhaseBits = 1;               ///< Glyphs get rasterized at 1 << s_subpixelPhaseBits subpixel phases, 2 leave the pre-warm set well within the default glyph cache budget
+            u64 m_glyphRasterizationTicks = 0;          ///< Time spent rasterizing glyphs during the current frame
+            Thread m_glyphWorkerThread;
+            bool m_glyphWorkerStarted = false;
+            bool m_glyphWorkerExit = false;
+            std::mutex m_glyphWorkerMutex;
+            std::condition_variable m_glyphWorkerWake;
+            std::deque<GlyphJob> m_glyphJobs;
+            std::vector<RasterizedGlyph> m_rasterizedGlyphs;
+            std::unordered_set<u64> m_queuedGlyphs;     ///< Glyphs queued or being rasterized by the worker thread
+            std::vector<ScissoringConfig> m_placeholderAreas;   ///< Where placeholders got drawn, repainted once the worker finished glyphs
+
+            stbtt_fontinfo m_stdFont, m_localFont, m_extFont;
+            bool m_hasLocalFont = false;
+            std::array<std::unique_ptr<u32[]>, 0x10000 / GlyphIndexPageSize> m_glyphIndex;     ///< Font slot and glyph index of every BMP codepoint, see \ref lookupGlyph
+            std::array<int, 3> m_monospaceGlyphs = {};
+            GlyphExtents m_glyphExtents = {};
+
+            GlyphCache m_glyphCache;
+            std::vector<u8> m_glyphScratch;
+            std::unordered_map<u64, s32> m_glyphAdvances;
+            std::unordered_map<u64, AsciiAdvances> m_asciiAdvances;
+            std::unordered_map<u64, StringMetrics> m_stringMetrics;
+            std::unordered_map<u64, CutPoints> m_cutPoints;
+            size_t m_cutPointsBytes = 0;
+            static inline size_t s_glyphCacheBudget = GlyphCache::DefaultBudget;
+            TextSpriteCache m_textSprites;
+            static inline size_t s_textSpriteCacheBudget = TextSpriteCache::DefaultBudget;
+
+            static inline float s_opacity = 1.0F;
+            static inline LevelTable s_opacityTable = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF };   ///< Each alpha level with s_opacity applied
+
+            /**
+             * @brief Channel blend results, indexed by [alpha][src][dst]
+             */
+            static constexpr auto BlendTable = [] {
+                std::array<std::array<LevelTable, 16>, 16> table = {};
+
+                for (u8 alpha = 0; alpha < 16; alpha++)
+                    for (u8 src = 0; src < 16; src++)
+                        for (u8 dst = 0; dst < 16; dst++)
+                            table[alpha][src][dst] = (dst * alpha + src * (0x0F - alpha)) / 0xF;
+
+                return table;
+            }();
+
+            /**
+             * @brief Glyph pixel opacities, indexed by [color alpha][coverage]
+             */
+            static constexpr auto CoverageTable = [] {
+                std::array<LevelTable, 16> table = {};
+
+                for (u8 alpha = 0; alpha < 16; alpha++)
+                    for (u8 coverage = 0; coverage < 16; coverage++)
+                        table[alpha][coverage] = coverage * (float(alpha) / 0xF);
+
+                return table;
+            }();
+
+            /**
+             * @brief Circle edge opacities, indexed by the distance of a pixel center to the edge in 1/32 pixels, offset by 16
+             */
+            static constexpr auto CircleCoverageTable = [] {
+                std::array<u8, 33> table = {};
+
+                for (s32 distance = -16; distance <= 16; distance++)
+                    table[distance + 16] = (0xF * (16 - distance) + 16) / 32;
+
+                return table;
+            }();
+
+            /**
+             * @brief Integer square root
+             *
+             * @param value Value, must not be negative
+             * @return Largest integer whose square is not greater than value
+             */
+            static s32 isqrt(s32 value) {
+                s32 root = sqrtf(value);
+
+                while (root * root > value)
+                    root--;
+                while ((root + 1) * (root + 1) <= value)
+                    root++;
+
+                return root;
+            }
+
+            /**
+             * @brief Gets the opacity of a pixel on the edge of a circle
+             * @note The edge sits half a pixel outside of radius to match the size of non anti-aliased circles
+             *
+             * @param dx X distance from the center
+             * @param dy Y distance from the center
+             * @param radius Radius
+             * @return Coverage level
+             */
+            static u8 circleCoverage(s32 dx, s32 dy, s32 radius) {
+                const s32 diameter = 2 * radius + 1;
+                const s32 distance = (4 * (dx * dx + dy * dy) - diameter * diameter) * 8 / diameter;
+
+                return CircleCoverageTable[std::clamp(distance, -16, 16) + 16];
+            }
+
+            /**
+             * @brief Calculates how far each row of a filled circle extends to either side of its center
+             * @note Traces the same outline as the midpoint circle algorithm. Rows the algorithm never reaches are -1
+             *
+             * @param radius Radius
+             * @param halfWidths Half widths, indexed by distance from the center row
+             */
+            static void getCircleHalfWidths(s32 radius, std::vector<s32> &halfWidths) {
+                halfWidths.assign(radius + 1, -1);
+
+                s32 x = radius;
+                s32 y = 0;
+                s32 radiusError = 0;
+                s32 xChange = 1 - (radius << 1);
+                s32 yChange = 0;
+
+                while (x >= y) {
+                    halfWidths[y] = std::max(halfWidths[y], x);
+                    halfWidths[x] = std::max(halfWidths[x], y);
+
+                    y++;
+                    radiusError += yChange;
+                    yChange += 2;
+                    if (((radiusError << 1) + xChange) > 0) {
+                        x--;
+                        radiusError += xChange;
+                        xChange += 2;
+                    }
+                }
+            }
+
+            /**
+             * @brief Draws a horizontal line whose opacity varies per pixel
+             * @note Neighbouring pixels with the same coverage are drawn as one span
+             *
+             * @param x0 First X pos
+             * @param x1 One past the last X pos
+             * @param y Y pos
+             * @param color Color
+             * @param coverage Callback returning the coverage level of a X pos
+             */
+            template<typename F>
+            void drawCoverageSpan(s32 x0, s32 x1, s32 y, Color color, F coverage) {
+                if (x0 >= x1)
+                    return;
+
+                u8 level = coverage(x0);
+                for (s32 x = x0 + 1; ; x++) {
+                    const u8 nextLevel = x < x1 ? coverage(x) : 0xFF;
+                    if (nextLevel == level)
+                        continue;
+
+                    if (level != 0) {
+                        Color runColor = color;
+                        runColor.a = Renderer::CoverageTable[color.a][level];
+                        this->drawRect(x0, y, x - x0, 1, runColor);
+                    }
+
+                    if (x >= x1)
+                        break;
+
+                    x0 = x;
+                    level = nextLevel;
+                }
+            }
+
+            /**
+             * @brief Draws one anti-aliased row of a circle stretched horizontally between two centers
+             *
+             * @param left Left center X pos
+             * @param right Right center X pos, must not be left of the left one
+             * @param y Y pos
+             * @param dy Y distance from the centers
+             * @param radius Radius
+             * @param color Color
+             */
+            void drawSmoothRow(s32 left, s32 right, s32 y, s32 dy, s32 radius, Color color) {
+                const s32 outer = isqrt(radius * radius + 2 * radius - dy * dy);
+                const s32 innerSquared = radius * radius - 1 - dy * dy;
+                const s32 inner = innerSquared >= 0 ? isqrt(innerSquared) : -1;
+
+                auto coverage = [&](s32 x) {
+                    const s32 dx = x < left ? x - left : (x > right ? x - right : 0);
+                    return circleCoverage(dx, dy, radius);
+                };
+
+                if (inner >= 0) {
+                    this->drawRect(left - inner, y, right - left + 2 * inner + 1, 1, color);
+                    this->drawCoverageSpan(left - outer, left - inner, y, color, coverage);
+                    this->drawCoverageSpan(right + inner + 1, right + outer + 1, y, color, coverage);
+                } else {
+                    this->drawCoverageSpan(left - outer, right + outer + 1, y, color, coverage);
+                }
+            }
+
+            /**
+             * @brief Get the current framebuffer address
+             *
+             * @return Framebuffer address
+             */
+            inline void* getCurrentFramebuffer() {
+                return this->m_currentFramebuffer;
+            }
+
+            /**
+             * @brief Get the next framebuffer address
+             *
+             * @return Next framebuffer address
+             */
+            inline void* getNextFramebuffer() {
+                return static_cast<u8*>(this->m_framebuffer.buf) + this->getNextFramebufferSlot() * this->getFramebufferSize();
+            }
+
+            /**
+             * @brief Get the framebuffer size
+             *
+             * @return Framebuffer size
+             */
+            inline size_t getFramebufferSize() {
+                return this->m_framebuffer.fb_size;
+            }
+
+            /**
+             * @brief Get the number of framebuffers in use
+             *
+             * @return Number of framebuffers
+             */
+            inline size_t getFramebufferCount() {
+                return this->m_framebuffer.num_fbs;
+            }
+
+            /**
+             * @brief Get the currently used framebuffer's slot
+             *
+             * @return Slot
+             */
+            inline u8 getCurrentFramebufferSlot() {
+                return this->m_window.cur_slot;
+            }
+
+            /**
+             * @brief Get the next framebuffer's slot
+             *
+             * @return Next slot
+             */
+            inline u8 getNextFramebufferSlot() {
+                return (this->getCurrentFramebufferSlot() + 1) % this->getFramebufferCount();
+            }
+
+            /**
+             * @brief Waits for the vsync event
+             *
+             */
+            inline void waitForVSync() {
+                eventWait(&this->m_vsyncEvent, UINT64_MAX);
+            }
+
+            /**
+             * @brief Decodes a x and y coordinate into a offset into the swizzled framebuffer
+             *
+             * @param x X pos
+             * @param y Y Pos
+             * @return Offset
+             */
+            u32 getPixelOffset(s32 x, s32 y) {
+                const auto currScissorConfig = this->getScissoringConfig();
+                if (x < currScissorConfig.x ||
+                    y < currScissorConfig.y ||
+                    x >= currScissorConfig.x + currScissorConfig.w ||
+                    y >= currScissorConfig.y + currScissorConfig.h)
+                        return UINT32_MAX;
+
+                return this->getSwizzledOffset(x, y);
+            }
+
+            /**
+             * @brief Enables scissoring for an area given with exclusive right and bottom edge
+             *
+             * @param area Boundaries
+             */
+            inline void pushScissoring(const ScissoringConfig &area) {
+                const auto parent = this->getScissoringConfig();
+
+                const s32 x0 = std::max(area.x, parent.x);
+                const s32 y0 = std::max(area.y, parent.y);
+                const s32 x1 = std::min(area.x + area.w, parent.x + parent.w);
+                const s32 y1 = std::min(area.y + area.h, parent.y + parent.h);
+
+                // Past the maximum depth the innermost stored boundaries stay in effect
+                if (this->m_scissoringDepth < this->m_scissoringStack.size())
+                    this->m_scissoringStack[this->m_scissoringDepth] = { x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0) };
+
+                this->m_scissoringDepth++;
+            }
+
+            /**
+             * @brief Gets the area that can currently be drawn to
+             *
+             * @return Innermost scissoring boundaries, already intersected with all outer ones and the framebuffer. Right and bottom edge are exclusive
+             */
+            inline ScissoringConfig getScissoringConfig() {
+                if (this->m_scissoringDepth == 0)
+                    return { 0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight };
+
+                return this->m_scissoringStack[std::min(this->m_scissoringDepth, this->m_scissoringStack.size()) - 1];
+            }
+
+            /**
+             * @brief Decodes a x and y coordinate into a offset into the swizzled framebuffer without checking any bounds
+             *
+             * @param x X pos
+             * @param y Y Pos
+             * @return Offset
+             */
+            inline u32 getSwizzledOffset(s32 x, s32 y) {
+                return this->m_pixelOffsetsX[x] + this->m_pixelOffsetsY[y];
+            }
+
+            /**
+             * @brief Builds the per-axis lookup tables used by \ref getSwizzledOffset for the current framebuffer size
+             * @note Every term of the block-linear address only depends on either x or y, so the offset is the sum of both tables
+             */
+            void initPixelOffsetTables() {
+                this->m_pixelOffsetsX.resize(cfg::FramebufferWidth);
+                this->m_pixelOffsetsY.resize(cfg::FramebufferHeight);
+
+                for (u32 x = 0; x < cfg::FramebufferWidth; x++)
+                    this->m_pixelOffsetsX[x] = getSwizzledOffsetX(x);
+
+                for (u32 y = 0; y < cfg::FramebufferHeight; y++)
+                    this->m_pixelOffsetsY[y] = getSwizzledOffsetY(y, cfg::FramebufferWidth);
+            }
+
+            /**
+             * @brief Walks a clipped rectangle row by row in runs of pixels that are contiguous in the swizzled framebuffer
+             * @note Runs are at most 8 pixels long, one row of a GOB sector
+             *
+             * @param x0 Left edge, inclusive
+             * @param y0 Top edge, inclusive
+             * @param x1 Right edge, exclusive
+             * @param y1 Bottom edge, exclusive
+             * @param f Callback taking the first pixel of the run, its x and y position and the number of pixels
+             */
+            template<typename F>
+            ALWAYS_INLINE void forEachSpan(s32 x0, s32 y0, s32 x1, s32 y1, F f) {
+                u16 *framebuffer = static_cast<u16*>(this->getCurrentFramebuffer());
+
+                for (s32 currY = y0; currY < y1; currY++) {
+                    u16 *row = framebuffer + this->m_pixelOffsetsY[currY];
+
+                    s32 currX = x0;
+                    while (currX < x1) {
+                        const s32 spanEnd = std::min((currX & ~7) + 8, x1);
+
+                        f(row + this->m_pixelOffsetsX[currX], currX, currY, spanEnd - currX);
+
+                        currX = spanEnd;
+                    }
+                }
+            }
+
+            /**
+             * @brief Clips a rectangle against the framebuffer and the current scissor rectangle
+             *
+             * @param x0 Left edge, inclusive
+             * @param y0 Top edge, inclusive
+             * @param x1 Right edge, exclusive
+             * @param y1 Bottom edge, exclusive
+             * @return Whether any part of the rectangle is left to draw
+             */
+            inline bool clipRect(s32 &x0, s32 &y0, s32 &x1, s32 &y1) {
+                const auto currScissorConfig = this->getScissoringConfig();
+
+                x0 = std::max(x0, currScissorConfig.x);
+                y0 = std::max(y0, currScissorConfig.y);
+                x1 = std::min(x1, currScissorConfig.x + currScissorConfig.w);
+                y1 = std::min(y1, currScissorConfig.y + currScissorConfig.h);
+
+                return x0 < x1 && y0 < y1;
+            }
+
+            /**
+             * @brief Draws the part of a draw command that lies inside the given area
+             *
+             * @param command Draw command
+             * @param x0 Left edge, inclusive
+             * @param y0 Top edge, inclusive
+             * @param x1 Right edge, exclusive
+             * @param y1 Bottom edge, exclusive
+             */
+            void rasterize(const DrawCommand &command, s32 x0, s32 y0, s32 x1, s32 y1) {
+                switch (command.type) {
+                    case DrawCommand::Type::Fill:
+                        this->forEachSpan(x0, y0, x1, y1, [&](u16 *span, s32, s32, s32 count) {
+                            std::fill_n(span, count, command.color.rgba);
+                        });
+                        break;
+                    case DrawCommand::Type::BlendDst:
+                        this->forEachSpan(x0, y0, x1, y1, [&](u16 *span, s32, s32, s32 count) {
+                            blendSpanDst(span, count, command.color);
+                        });
+                        break;
+                    case DrawCommand::Type::BlendSrc:
+                        this->forEachSpan(x0, y0, x1, y1, [&](u16 *span, s32, s32, s32 count) {
+                            for (s32 i = 0; i < count; i++) {
+                                const Color src(span[i]);
+                                span[i] = blendChannels(src, command.color, command.color.a) | src.a << 12;
+                            }
+                        });
+                        break;
+                    case DrawCommand::Type::Coverage:
+                        this->forEachSpan(x0, y0, x1, y1, [&](u16 *span, s32 spanX, s32 spanY, s32 count) {
+                            blendSpanCoverage(span, command.data + command.dataStride * (spanY - command.dataY), spanX - command.dataX, count, command.color, command.alphaTable);
+                        });
+                        break;
+                    case DrawCommand::Type::Glyph:
+                        assert(command.glyph->rowRuns != nullptr && command.glyph->runs != nullptr);
+
+                        for (s32 currY = y0; currY < y1; currY++) {
+                            const u8 *run = command.glyph->runs + command.glyph->rowRuns[currY - command.dataY];
+                            const u8 *coverage = command.data + command.dataStride * (currY - command.dataY);
+
+                            // Empty runs get skipped, fully covered ones filled and only partially covered ones blended
+                            for (s32 runX = command.dataX; runX < x1; run++) {
+                                const s32 runEnd = runX + (*run & 0x3F) + 1;
+                                const auto type = static_cast<GlyphCache::RunType>(*run >> 6);
+                                const s32 spanX0 = std::max(runX, x0), spanX1 = std::min(runEnd, x1);
+
+                                if (type != GlyphCache::RunType::Skip && spanX0 < spanX1) {
+                                    this->forEachSpan(spanX0, currY, spanX1, currY + 1, [&](u16 *span, s32 spanX, s32, s32 count) {
+                                        if (type == GlyphCache::RunType::Solid)
+                                            std::fill_n(span, count, command.color.rgba);
+                                        else
+                                            blendSpanCoverage(span, coverage, spanX - command.dataX, count, command.color, command.alphaTable);
+                                    });
+                                }
+
+                                runX = runEnd;
+                            }
+                        }
+                        break;
+                    case DrawCommand::Type::Bitmap:
+                        this->forEachSpan(x0, y0, x1, y1, [&](u16 *span, s32 spanX, s32 spanY, s32 count) {
+                            blendSpanBitmap(span, command.data + ((spanY - command.dataY) * command.dataStride + (spanX - command.dataX)) * 4, count, command.alphaTable);
+                        });
+                        break;
+                    case DrawCommand::Type::Texture: {
+                        const bool copyOpaque = command.alphaTable[0xF] == 0xF;
+
+                        for (s32 currY = y0; currY < y1; currY++) {
+                            const u16 *pixels = command.texture->getRow(currY - command.dataY);
+
+                            command.texture->forEachRun(currY - command.dataY, [&](const Texture::Run &run) {
+                                const s32 runX0 = std::max(command.dataX + run.x, x0);
+                                const s32 runX1 = std::min(command.dataX + run.x + run.length, x1);
+
+                                this->forEachSpan(runX0, currY, runX1, currY + 1, [&](u16 *span, s32 spanX, s32, s32 count) {
+                                    if (run.opaque && copyOpaque)
+                                        copySpanTexture(span, pixels + (spanX - command.dataX), count);
+                                    else
+                                        blendSpanTexture(span, pixels + (spanX - command.dataX), count, command.alphaTable);
+                                });
+                            });
+                        }
+                        break;
+                    }
+                }
+            }
+
+            /**
+             * @brief Draws a draw command right away or records it in recording mode
+             *
+             * @param command Draw command
+             */
+            inline void submit(const DrawCommand &command) {
+                if (this->m_recording)
+                    this->m_drawCommands.push_back(command);
+                else
+                    this->rasterize(command, command.x0, command.y0, command.x1, command.y1);
+            }
+
+            /**
+             * @brief Calls a function with the index of every tile a draw command touches
+             *
+             * @param command Draw command
+             * @param tilesX Number of tiles per row
+             * @param f Callback taking the tile index
+             */
+            template<typename F>
+            static ALWAYS_INLINE void forEachTile(const DrawCommand &command, s32 tilesX, F f) {
+                for (s32 tileY = command.y0 / TileHeight; tileY <= (command.y1 - 1) / TileHeight; tileY++)
+                    for (s32 tileX = command.x0 / TileWidth; tileX <= (command.x1 - 1) / TileWidth; tileX++)
+                        f(tileY * tilesX + tileX);
+            }
+
+            /**
+             * @brief Draws all recorded draw commands tile by tile
+             * @note Within each tile the commands are drawn in the order they were recorded, giving the same result as drawing them right away
+             */
+            void flushDrawCommands() {
+                const s32 tilesX = (cfg::FramebufferWidth + TileWidth - 1) / TileWidth;
+                const s32 tilesY = (cfg::FramebufferHeight + TileHeight - 1) / TileHeight;
+                auto &starts = this->m_tileCommandStarts;
+
+                // Count the commands of each tile and turn the counts into the end of each tile's range in the flat list
+                starts.assign(tilesX * tilesY + 1, 0);
+                for (const auto &command : this->m_drawCommands)
+                    forEachTile(command, tilesX, [&](u32 tile) { starts[tile]++; });
+
+                std::partial_sum(starts.begin(), starts.end(), starts.begin());
+                this->m_tileCommands.resize(starts.back());
+
+                // Filling the ranges back to front leaves every range sorted and every entry pointing to its range's start
+                for (u32 i = this->m_drawCommands.size(); i-- > 0;)
+                    forEachTile(this->m_drawCommands[i], tilesX, [&](u32 tile) { this->m_tileCommands[--starts[tile]] = i; });
+
+                const u32 columnCount = tilesX * ((tilesY + TilesPerColumn - 1) / TilesPerColumn);
+                u32 threadCount = std::clamp<u32>(Renderer::s_rasterizerThreadCount, 1, MaxRasterizerThreads);
+
+                if (threadCount > 1) {
+                    this->startRasterizerThreads(threadCount - 1);
+                    threadCount = std::min(threadCount, this->m_rasterizerThreadsStarted + 1);
+                }
+
+                // Split the columns of tiles between all rasterizer threads. Threads running out of work steal from the others
+                for (u32 i = 0; i < MaxRasterizerThreads; i++) {
+                    const u32 begin = i < threadCount ? columnCount * i / threadCount : 0;
+                    const u32 end = i < threadCount ? columnCount * (i + 1) / threadCount : 0;
+
+                    this->m_rasterizerWork[i] = begin | end << 16;
+                }
+
+                if (threadCount > 1) {
+                    {
+                        std::scoped_lock lock(this->m_rasterizerMutex);
+                        this->m_rasterizerGeneration++;
+                        this->m_rasterizerPending = this->m_rasterizerThreadsStarted;
+                    }
+                    this->m_rasterizerStart.notify_all();
+
+                    this->rasterizeWork(0);
+
+                    std::unique_lock lock(this->m_rasterizerMutex);
+                    this->m_rasterizerDone.wait(lock, [this] { return this->m_rasterizerPending == 0; });
+                } else {
+                    // Nothing to share the work with, skip taking columns one by one
+                    for (u32 column = 0; column < columnCount; column++)
+                        this->rasterizeColumn(column);
+                }
+
+                this->m_drawCommands.clear();
+            }
+
+            /**
+             * @brief Draws all tiles of one column of blocks
+             * @note Blocks are stacked in columns of 128 pixel rows, so the tiles of a column are contiguous in memory
+             *
+             * @param column Column index, counting left to right and then top to bottom
+             */
+            void rasterizeColumn(u32 column) {
+                const s32 tilesX = (cfg::FramebufferWidth + TileWidth - 1) / TileWidth;
+                const s32 tilesY = (cfg::FramebufferHeight + TileHeight - 1) / TileHeight;
+                const auto &starts = this->m_tileCommandStarts;
+
+                const s32 tileX = column % tilesX;
+                const s32 columnY = column / tilesX * TilesPerColumn;
+
+                for (s32 tileY = columnY; tileY < std::min(columnY + TilesPerColumn, tilesY); tileY++) {
+                    const u32 tile = tileY * tilesX + tileX;
+                    const s32 tileX0 = tileX * TileWidth, tileY0 = tileY * TileHeight;
+                    const s32 tileX1 = std::min(tileX0 + TileWidth, static_cast<s32>(cfg::FramebufferWidth));
+                    const s32 tileY1 = std::min(tileY0 + TileHeight, static_cast<s32>(cfg::FramebufferHeight));
+
+                    const bool fullTile = tileX1 - tileX0 == TileWidth && tileY1 - tileY0 == TileHeight;
+                    u16 *tileData = static_cast<u16*>(this->getCurrentFramebuffer()) + this->getSwizzledOffset(tileX0, tileY0);
+
+                    for (u32 i = starts[tile]; i < starts[tile + 1]; i++) {
+                        const auto &command = this->m_drawCommands[this->m_tileCommands[i]];
+
+                        // Solid colors don't care about the pixel order, a fully covered tile can be treated as one contiguous run
+                        if (fullTile && command.x0 <= tileX0 && command.y0 <= tileY0 && command.x1 >= tileX1 && command.y1 >= tileY1) {
+                            if (command.type == DrawCommand::Type::Fill) {
+                                std::fill_n(tileData, TileWidth * TileHeight, command.color.rgba);
+                                continue;
+                            } else if (command.type == DrawCommand::Type::BlendDst) {
+                                blendSpanDst(tileData, TileWidth * TileHeight, command.color);
+                                continue;
+                            }
+                        }
+
+                        this->rasterize(command, std::max(command.x0, tileX0), std::max(command.y0, tileY0), std::min(command.x1, tileX1), std::min(command.y1, tileY1));
+                    }
+                }
+            }
+
+            /**
+             * @brief Takes the next column from the front of a thread's share of the work
+             *
+             * @param thread Thread index
+             * @param column Taken column
+             * @return Whether there was any work left
+             */
+            bool takeWork(u32 thread, u32 &column) {
+                auto &work = this->m_rasterizerWork[thread];
+                u32 range = work.load();
+
+                do {
+                    const u32 begin = range & 0xFFFF, end = range >> 16;
+                    if (begin >= end)
+                        return false;
+
+                    column = begin;
+                } while (!work.compare_exchange_weak(range, (column + 1) | (range & 0xFFFF0000)));
+
+                return true;
+            }
+
+            /**
+             * @brief Steals the last column from the back of another thread's share of the work
+             *
+             * @param thread Thread index to steal from
+             * @param column Stolen column
+             * @return Whether there was any work left
+             */
+            bool stealWork(u32 thread, u32 &column) {
+                auto &work = this->m_rasterizerWork[thread];
+                u32 range = work.load();
+
+                do {
+                    const u32 begin = range & 0xFFFF, end = range >> 16;
+                    if (begin >= end)
+                        return false;
+
+                    column = end - 1;
+                } while (!work.compare_exchange_weak(range, (range & 0xFFFF) | column << 16));
+
+                return true;
+            }
+
+            /**
+             * @brief Draws columns until there's no work left for any thread
+             *
+             * @param thread Index of the calling thread
+             */
+            void rasterizeWork(u32 thread) {
+                u32 column;
+
+                while (true) {
+                    bool found = this->takeWork(thread, column);
+
+                    for (u32 i = 1; !found && i < MaxRasterizerThreads; i++)
+                        found = this->stealWork((thread + i) % MaxRasterizerThreads, column);
+
+                    if (!found)
+                        break;
+
+                    this->rasterizeColumn(column);
+                }
+            }
+
+            /**
+             * @brief Rasterizer worker thread, draws its share of the recorded frames
+             *
+             * @param args Used to pass in a pointer to a \ref RasterizerThread struct
+             */
+            static void rasterizerThreadFunc(void *args) {
+                auto &thread = *static_cast<RasterizerThread*>(args);
+                auto &renderer = *thread.renderer;
+                u32 generation = 0;
+
+                while (true) {
+                    {
+                        std::unique_lock lock(renderer.m_rasterizerMutex);
+                        renderer.m_rasterizerStart.wait(lock, [&] { return renderer.m_rasterizerExit || renderer.m_rasterizerGeneration != generation; });
+
+                        if (renderer.m_rasterizerExit)
+                            return;
+
+                        generation = renderer.m_rasterizerGeneration;
+                    }
+
+                    renderer.rasterizeWork(thread.index);
+
+                    std::scoped_lock lock(renderer.m_rasterizerMutex);
+                    if (--renderer.m_rasterizerPending == 0)
+                        renderer.m_rasterizerDone.notify_one();
+                }
+            }
+
+            /**
+             * @brief Starts rasterizer worker threads, each on a different core other than the calling one
+             * @note Starts fewer threads once no other cores of the process core mask are left
+             *
+             * @param count Number of worker threads needed
+             */
+            void startRasterizerThreads(u32 count) {
+                u64 coreMask = 0;
+                svcGetInfo(&coreMask, InfoType_CoreMask, CUR_PROCESS_HANDLE, 0);
+
+                // Threads sharing a core with the one ending the frame would only take turns with it
+                coreMask &= ~(1ULL << svcGetCurrentProcessorNumber());
+
+                // Cores of the threads started before are taken already
+                for (u32 i = 0; i < this->m_rasterizerThreadsStarted; i++)
+                    coreMask &= coreMask - 1;
+
+                while (this->m_rasterizerThreadsStarted < count && coreMask != 0) {
+                    auto &thread = this->m_rasterizerThreads[this->m_rasterizerThreadsStarted];
+                    thread.renderer = this;
+                    thread.index = this->m_rasterizerThreadsStarted + 1;
+
+                    const s32 core = __builtin_ctzll(coreMask);
+                    coreMask &= coreMask - 1;
+
+                    if (R_FAILED(threadCreate(&thread.thread, rasterizerThreadFunc, &thread, nullptr, 0x4000, 0x2c, core)))
+                        break;
+
+                    threadStart(&thread.thread);
+                    this->m_rasterizerThreadsStarted++;
+                }
+            }
+
+            /**
+             * @brief Stops all rasterizer worker threads
+             *
+             */
+            void stopRasterizerThreads() {
+                {
+                    std::scoped_lock lock(this->m_rasterizerMutex);
+                    this->m_rasterizerExit = true;
+                }
+                this->m_rasterizerStart.notify_all();
+
+                for (u32 i = 0; i < this->m_rasterizerThreadsStarted; i++) {
+                    threadWaitForExit(&this->m_rasterizerThreads[i].thread);
+                    threadClose(&this->m_rasterizerThreads[i].thread);
+                }
+
+                this->m_rasterizerThreadsStarted = 0;
+                this->m_rasterizerExit = false;
+            }
+
+            /**
+             * @brief Identifies the loaded system fonts by hashing their head tables, which hold each font's revision and checksum
+             *
+             * @return Font identity
+             */
+            u64 getFontIdentity() const {
+                u64 hash = 0xCBF2'9CE4'8422'2325;
+
+                auto addFont = [&hash](const stbtt_fontinfo &font) {
+                    const u8 *head = font.data + font.head;
+                    for (u32 i = 0; i < 54; i++)
+                        hash = (hash ^ head[i]) * 0x100'0000'01B3;
+                };
+
+                addFont(this->m_stdFont);
+                addFont(this->m_extFont);
+                if (this->m_hasLocalFont)
+                    addFont(this->m_localFont);
+
+                return hash;
+            }
+
+            /**
+             * @brief Checks if a glyph atlas record describes a glyph \ref saveGlyphAtlas could have written
+             * @note Empty glyphs are stored with a size of zero, all others have to fit on an atlas page and match their bounds
+             *
+             * @param record Record
+             * @return Whether the record is valid
+             */
+            static bool isValidGlyphAtlasRecord(const GlyphAtlasRecord &record) {
+                if (record.fontSlot > static_cast<u8>(FontSlot::Extended))
+                    return false;
+
+                if (record.width == 0 && record.height == 0)
+                    return true;
+
+                if (record.width == 0 || record.height == 0 || record.width > GlyphCache::PageWidth || record.height > GlyphCache::PageHeight)
+                    return false;
+
+                return static_cast<s64>(record.bounds[2]) - record.bounds[0] == record.width && static_cast<s64>(record.bounds[3]) - record.bounds[1] == record.height;
+            }
+
+            /**
+             * @brief Fills the glyph cache from the persistent glyph atlas file, read in one go
+             * @note Files written for other fonts or versions get ignored, as do files with any invalid record
+             */
+            void loadGlyphAtlas() {
+                FsFileSystem fsSdmc;
+                if (R_FAILED(fsOpenSdCardFileSystem(&fsSdmc)))
+                    return;
+                hlp::ScopeGuard fsGuard([&] { fsFsClose(&fsSdmc); });
+
+                FsFile file;
+                if (R_FAILED(fsFsOpenFile(&fsSdmc, GlyphAtlasPath, FsOpenMode_Read, &file)))
+                    return;
+                hlp::ScopeGuard fileGuard([&] { fsFileClose(&file); });
+
+                s64 fileSize;
+                if (R_FAILED(fsFileGetSize(&file, &fileSize)) || fileSize < static_cast<s64>(sizeof(GlyphAtlasHeader)) || fileSize > MaxGlyphAtlasFileSize)
+                    return;
+
+                std::vector<u8> data(fileSize);
+                u64 readSize;
+                if (R_FAILED(fsFileRead(&file, 0, data.data(), fileSize, FsReadOption_None, &readSize)) || readSize != static_cast<u64>(fileSize))
+                    return;
+
+                GlyphAtlasHeader header;
+                std::memcpy(&header, data.data(), sizeof(header));
+                if (header.magic != GlyphAtlasMagic || header.version != GlyphAtlasVersion || header.fontIdentity != this->getFontIdentity())
+                    return;
+
+                // Find all complete records first, they're stored most recently used first but have to be inserted the other way round
+                std::vector<size_t> recordOffsets;
+                size_t offset = sizeof(GlyphAtlasHeader);
+                for (u32 i = 0; i < header.glyphCount && offset + sizeof(GlyphAtlasRecord) <= data.size(); i++) {
+                    GlyphAtlasRecord record;
+                    std::memcpy(&record, data.data() + offset, sizeof(record));
+
+                    // Nothing in a file with broken records can be trusted, not even the records before it
+                    if (!isValidGlyphAtlasRecord(record))
+                        return;
+
+                    const size_t coverageSize = static_cast<size_t>((record.width + 1) / 2) * record.height;
+                    if (offset + sizeof(record) + coverageSize > data.size())
+                        break;
+
+                    recordOffsets.push_back(offset);
+                    offset += sizeof(record) + coverageSize;
+                }
+
+                stbtt_fontinfo *fonts[] = { &this->m_stdFont, &this->m_localFont, &this->m_extFont };
+
+                for (auto it = recordOffsets.rbegin(); it != recordOffsets.rend(); ++it) {
+                    GlyphAtlasRecord record;
+                    std::memcpy(&record, data.data() + *it, sizeof(record));
+
+                    if (this->m_glyphCache.contains(record.key))
+                        continue;
+
+                    GlyphCache::Glyph glyph = {
+                        .currFont = fonts[record.fontSlot],
+                        .currFontSize = record.scale,
+                        .bounds = { record.bounds[0], record.bounds[1], record.bounds[2], record.bounds[3] },
+                        .xAdvance = record.xAdvance,
+                        .glyphBmp = nullptr,
+                        .width = record.width,
+                        .height = record.height,
+                        .stride = 0,
+                        .rowRuns = nullptr,
+                        .runs = nullptr
+                    };
+
+                    this->m_glyphCache.insertPacked(record.key, glyph, data.data() + *it + sizeof(record));
+                }
+
+                this->m_glyphCache.evict(Renderer::s_glyphCacheBudget);
+                this->m_glyphAtlasSavedInsertions = this->m_glyphCache.getStats().insertions;
+            }
+
+            /**
+             * @brief Waits for the glyph atlas writer thread to finish, if there's one
+             */
+            void joinGlyphAtlasWriter() {
+                if (!this->m_glyphAtlasWriterStarted)
+                    return;
+
+                threadWaitForExit(&this->m_glyphAtlasWriterThread);
+                threadClose(&this->m_glyphAtlasWriterThread);
+                this->m_glyphAtlasWriterStarted = false;
+            }
+
+            /**
+             * @brief Glyph atlas writer thread, replaces the atlas file with the serialized glyph cache
+             *
+             * @param args Used to pass in a pointer to the \ref Renderer
+             */
+            static void glyphAtlasWriterThreadFunc(void *args) {
+                auto &renderer = *static_cast<Renderer*>(args);
+                hlp::ScopeGuard writingGuard([&] { renderer.m_glyphAtlasWriting = false; });
+
+                FsFileSystem fsSdmc;
+                if (R_FAILED(fsOpenSdCardFileSystem(&fsSdmc)))
+                    return;
+                hlp::ScopeGuard fsGuard([&] { fsFsClose(&fsSdmc); });
+
+                // Write to a temporary file first so a cut off write never leaves a broken atlas behind
+                fsFsCreateDirectory(&fsSdmc, "/config/tesla");
+                fsFsDeleteFile(&fsSdmc, GlyphAtlasTempPath);
+                if (R_FAILED(fsFsCreateFile(&fsSdmc, GlyphAtlasTempPath, renderer.m_glyphAtlasFile.size(), 0)))
+                    return;
+
+                {
+                    FsFile file;
+                    if (R_FAILED(fsFsOpenFile(&fsSdmc, GlyphAtlasTempPath, FsOpenMode_Write, &file)))
+                        return;
+                    hlp::ScopeGuard fileGuard([&] { fsFileClose(&file); });
+
+                    if (R_FAILED(fsFileWrite(&file, 0, renderer.m_glyphAtlasFile.data(), renderer.m_glyphAtlasFile.size(), FsWriteOption_Flush)))
+                        return;
+                }
+
+                fsFsDeleteFile(&fsSdmc, GlyphAtlasPath);
+                fsFsRenameFile(&fsSdmc, GlyphAtlasTempPath, GlyphAtlasPath);
+            }
+
+            /**
+             * @brief Serializes the glyph cache and writes it to the persistent glyph atlas file in the background
+             * @note Does nothing if no glyphs got added since the last save or the last write is still running
+             */
+            void saveGlyphAtlas() {
+                if (this->m_glyphCache.getStats().insertions == this->m_glyphAtlasSavedInsertions || this->m_glyphAtlasWriting)
+                    return;
+
+                this->joinGlyphAtlasWriter();
+
+                auto &file = this->m_glyphAtlasFile;
+                file.resize(sizeof(GlyphAtlasHeader));
+
+                u32 glyphCount = 0;
+                this->m_glyphCache.forEachGlyph([&](u64 key, const GlyphCache::Glyph &glyph) {
+                    // Glyphs that needed a page of their own are rare enough to get rasterized again
+                    if (glyph.glyphBmp != nullptr && (glyph.width > GlyphCache::PageWidth || glyph.height > GlyphCache::PageHeight))
+                        return;
+
+                    GlyphAtlasRecord record = {
+                        .key = key,
+                        .scale = glyph.currFontSize,
+                        .bounds = { glyph.bounds[0], glyph.bounds[1], glyph.bounds[2], glyph.bounds[3] },
+                        .xAdvance = glyph.xAdvance,
+                        .width = static_cast<u16>(glyph.glyphBmp != nullptr ? glyph.width : 0),
+                        .height = static_cast<u16>(glyph.glyphBmp != nullptr ? glyph.height : 0),
+                        .fontSlot = static_cast<u8>(glyph.currFont == &this->m_extFont ? FontSlot::Extended : (glyph.currFont == &this->m_localFont ? FontSlot::Local : FontSlot::Standard)),
+                        .reserved = { }
+                    };
+
+                    // Glyphs start on an even pixel of their atlas page and odd widths get padded with an empty pixel, so rows can be copied byte by byte
+                    const size_t offset = file.size();
+                    const s32 packedStride = (record.width + 1) / 2;
+                    file.resize(offset + sizeof(record) + packedStride * record.height);
+                    std::memcpy(file.data() + offset, &record, sizeof(record));
+
+                    for (s32 y = 0; y < record.height; y++)
+                        std::memcpy(file.data() + offset + sizeof(record) + y * packedStride, glyph.glyphBmp + y * glyph.stride, packedStride);
+
+                    glyphCount++;
+                });
+
+                const GlyphAtlasHeader header = { .magic = GlyphAtlasMagic, .version = GlyphAtlasVersion, .fontIdentity = this->getFontIdentity(), .glyphCount = glyphCount, .reserved = 0 };
+                std::memcpy(file.data(), &header, sizeof(header));
+
+                this->m_glyphAtlasSavedInsertions = this->m_glyphCache.getStats().insertions;
+                this->m_glyphAtlasSaveTick = armGetSystemTick();
+                this->m_glyphAtlasWriting = true;
+
+                if (R_FAILED(threadCreate(&this->m_glyphAtlasWriterThread, glyphAtlasWriterThreadFunc, this, nullptr, 0x4000, 0x3F, -2))) {
+                    this->m_glyphAtlasWriting = false;
+                    return;
+                }
+
+                threadStart(&this->m_glyphAtlasWriterThread);
+                this->m_glyphAtlasWriterStarted = true;
+            }
+
+            /**
+             * @brief Builds the default glyph pre-warm set, ASCII and the button glyphs in the sizes used by the built-in elements
+             *
+             * @return Glyph set
+             */
+            static GlyphPrewarmSet getDefaultGlyphPrewarmSet() {
+                GlyphPrewarmSet set = { .characters = "", .fontSizes = { 15, 20, 23, 30 }, .monospace = false };
 
-                        stbtt_GetCodepointBitmapBoxSubpixel(glyph->currFont, currCharacter, glyph->currFontSize, glyph->currFontSize,
-                                                            0, 0, &glyph->bounds[0], &glyph->bounds[1], &glyph->bounds[2], &glyph->bounds[3]);
+                for (char c = ' '; c <= '~'; c++)
+                    set.characters += c;
 
-                        int yAdvance = 0;
-                        stbtt_GetCodepointHMetrics(glyph->currFont, monospace ? 'W' : currCharacter, &glyph->xAdvance, &yAdvance);
+                for (auto &keyInfo : impl::KEYS_INFO)
+                    set.characters += keyInfo.glyph;
 
-                        glyph->glyphBmp = stbtt_GetCodepointBitmap(glyph->currFont, glyph->currFontSize, glyph->currFontSize, currCharacter, &glyph->width, &glyph->height, nullptr, nullptr);
-                    } else {
-                        /* Use cached glyph */
-                        glyph = &it->second;
-                    }
+                // Back and OK glyphs of the footer
+                set.characters += "\uE0E0\uE0E1";
 
-                    if (glyph->glyphBmp != nullptr && !std::iswspace(currCharacter) && fontSize > 0 && color.a != 0x0) {
+                return set;
+            }
 
-                        auto x = currX + glyph->bounds[0];
-                        auto y = currY + glyph->bounds[1];
-                        for (s32 bmpY = 0; bmpY < glyph->height; bmpY++) {
-                            for (s32 bmpX = 0; bmpX < glyph->width; bmpX++) {
-                                auto bmpColor = glyph->glyphBmp[glyph->width * bmpY + bmpX] >> 4;
-                                if (bmpColor == 0xF) {
-                                    this->setPixel(x + bmpX, y + bmpY, color);
-                                } else if (bmpColor != 0x0) {
-                                    Color tmpColor = color;
-                                    tmpColor.a = bmpColor * (float(tmpColor.a) / 0xF);
-                                    this->setPixelBlendDst(x + bmpX, y + bmpY, tmpColor);
-                                }
-                            }
-                        }
+            /**
+             * @brief Glyph worker thread, rasterizes queued glyphs until it gets stopped
+             *
+             * @param args Used to pass in a pointer to the \ref Renderer
+             */
+            static void glyphWorkerThreadFunc(void *args) {
+                auto &renderer = *static_cast<Renderer*>(args);
 
-                    }
+                while (true) {
+                    GlyphJob job;
+                    {
+                        std::unique_lock lock(renderer.m_glyphWorkerMutex);
+                        renderer.m_glyphWorkerWake.wait(lock, [&] { return renderer.m_glyphWorkerExit || !renderer.m_glyphJobs.empty(); });
 
-                    currX += static_cast<s32>(glyph->xAdvance * glyph->currFontSize);
+                        if (renderer.m_glyphWorkerExit)
+                            return;
 
-                } while (*string != '\0');
+                        job = renderer.m_glyphJobs.front();
+                        renderer.m_glyphJobs.pop_front();
+                    }
 
-                maxX = std::max(currX, maxX);
+                    RasterizedGlyph rasterized = { .key = job.key, .glyph = {}, .coverage = {} };
+                    rasterizeGlyph(job.location, job.monospace, job.fontSize, job.phase, rasterized.glyph, rasterized.coverage);
 
-                return { maxX - x, currY - y };
+                    std::scoped_lock lock(renderer.m_glyphWorkerMutex);
+                    renderer.m_rasterizedGlyphs.push_back(std::move(rasterized));
+                }
             }
 
             /**
-             * @brief Limit a strings length and end it with "…"
+             * @brief Hands a glyph to the glyph worker thread, starting it when first needed
+             * @note The glyph's location has to be looked up on the calling thread, the worker only reads the fonts
              *
-             * @param string String to truncate
-             * @param maxLength Maximum length of string
+             * @param job Glyph to rasterize
+             * @return Whether the glyph got queued, false if the worker thread couldn't be started
              */
-            std::string limitStringLength(std::string string, bool monospace, float fontSize, s32 maxLength) {
-                if (string.size() < 2)
-                    return string;
-
-                s32 currX = 0;
-                ssize_t strPos = 0;
-                ssize_t codepointWidth;
+            bool queueGlyph(const GlyphJob &job) {
+                if (!this->m_glyphWorkerStarted) {
+                    if (R_FAILED(threadCreate(&this->m_glyphWorkerThread, glyphWorkerThreadFunc, this, nullptr, 0x4000, 0x2c, -2)))
+                        return false;
 
-                do {
-                    u32 currCharacter;
-                    codepointWidth = decode_utf8(&currCharacter, reinterpret_cast<const u8*>(&string[strPos]));
+                    threadStart(&this->m_glyphWorkerThread);
+                    this->m_glyphWorkerStarted = true;
+                }
 
-                    if (codepointWidth <= 0)
-                        break;
+                this->m_queuedGlyphs.insert(job.key);
 
-                    strPos += codepointWidth;
+                {
+                    std::scoped_lock lock(this->m_glyphWorkerMutex);
+                    this->m_glyphJobs.push_back(job);
+                }
+                this->m_glyphWorkerWake.notify_one();
 
-                    stbtt_fontinfo *currFont = nullptr;
+                return true;
+            }
 
-                    if (stbtt_FindGlyphIndex(&this->m_extFont, currCharacter))
-                        currFont = &this->m_extFont;
-                    else if(this->m_hasLocalFont && stbtt_FindGlyphIndex(&this->m_stdFont, currCharacter)==0)
-                        currFont = &this->m_localFont;
-                    else
-                        currFont = &this->m_stdFont;
+            /**
+             * @brief Adds the glyphs the worker thread finished to the cache and repaints the placeholders drawn in their place
+             * @note Must not be called while a frame is being drawn
+             */
+            void collectRasterizedGlyphs() {
+                std::vector<RasterizedGlyph> rasterizedGlyphs;
+                {
+                    std::scoped_lock lock(this->m_glyphWorkerMutex);
+                    if (this->m_rasterizedGlyphs.empty())
+                        return;
 
-                    float currFontSize = stbtt_ScaleForPixelHeight(currFont, fontSize);
+                    rasterizedGlyphs.swap(this->m_rasterizedGlyphs);
+                }
 
-                    int xAdvance = 0, yAdvance = 0;
-                    stbtt_GetCodepointHMetrics(currFont, monospace ? 'W' : currCharacter, &xAdvance, &yAdvance);
+                // The same glyph may have been rasterized synchronously in the meantime
+                for (auto &rasterized : rasterizedGlyphs) {
+                    if (!this->m_glyphCache.contains(rasterized.key))
+                        this->m_glyphCache.insert(rasterized.key, rasterized.glyph, rasterized.coverage.data());
 
-                    currX += static_cast<s32>(xAdvance * currFontSize);
+                    this->m_queuedGlyphs.erase(rasterized.key);
+                }
 
-                } while (string[strPos] != '\0' && string[strPos] != '\n' && currX < maxLength);
+                this->m_glyphCache.evict(Renderer::s_glyphCacheBudget);
 
-                string = string.substr(0, strPos - codepointWidth) + "…";
-                string.shrink_to_fit();
+                // Placeholders of glyphs still queued get recorded again when they're drawn next
+                for (const auto &area : this->m_placeholderAreas)
+                    this->addDamage(area.x, area.y, area.w, area.h);
 
-                return string;
+                this->m_placeholderAreas.clear();
             }
 
-        private:
-            Renderer() {}
-
             /**
-             * @brief Gets the renderer instance
-             *
-             * @return Renderer
+             * @brief Stops the glyph worker thread, dropping all glyphs it didn't finish yet
              */
-            static Renderer& get() {
-                static Renderer renderer;
+            void stopGlyphWorker() {
+                if (!this->m_glyphWorkerStarted)
+                    return;
 
-                return renderer;
+                {
+                    std::scoped_lock lock(this->m_glyphWorkerMutex);
+                    this->m_glyphWorkerExit = true;
+                    this->m_glyphJobs.clear();
+                }
+                this->m_glyphWorkerWake.notify_all();
+
+                threadWaitForExit(&this->m_glyphWorkerThread);
+                threadClose(&this->m_glyphWorkerThread);
+
+                this->m_rasterizedGlyphs.clear();
+                this->m_queuedGlyphs.clear();
+                this->m_glyphWorkerStarted = false;
+                this->m_glyphWorkerExit = false;
             }
 
             /**
-             * @brief Sets the opacity of the layer
-             *
-             * @param opacity Opacity
+             * @brief Queues the glyph pre-warm set to the glyph worker thread
+             * @note Called while waiting for the launch combo. The results get added to the cache by \ref finishGlyphPrewarm
              */
-            static void setOpacity(float opacity) {
-                opacity = std::clamp(opacity, 0.0F, 1.0F);
+            void startGlyphPrewarm() {
+                for (float fontSize : this->m_glyphPrewarmSet.fontSizes) {
+                    const u32 cachedFontSize = std::max(fontSize, 0.0F) * GlyphCache::SizeSubdivisions + 0.5F;
+                    const char *string = this->m_glyphPrewarmSet.characters.c_str();
 
-                Renderer::s_opacity = opacity;
-            }
+                    while (*string != '\0') {
+                        u32 currCharacter;
+                        ssize_t codepointWidth = decode_utf8(&currCharacter, reinterpret_cast<const u8*>(string));
 
-            bool m_initialized = false;
-            ViDisplay m_display;
-            ViLayer m_layer;
-            Event m_vsyncEvent;
+                        if (codepointWidth <= 0)
+                            break;
 
-            NWindow m_window;
-            Framebuffer m_framebuffer;
-            void *m_currentFramebuffer = nullptr;
+                        string += codepointWidth;
 
-            std::stack<ScissoringConfig> m_scissoringStack;
+                        if (currCharacter == '\n')
+                            continue;
 
-            stbtt_fontinfo m_stdFont, m_localFont, m_extFont;
-            bool m_hasLocalFont = false;
+                        // The pen can land on any phase, so all of them get pre-warmed
+                        for (u32 i = 0; i < (1U << Renderer::s_subpixelPhaseBits); i++) {
+                            const u8 phase = i << (std::countr_zero(GlyphCache::MaxSubpixelPhases) - Renderer::s_subpixelPhaseBits);
+                            const u64 key = GlyphCache::makeKey(currCharacter, this->m_glyphPrewarmSet.monospace, cachedFontSize, phase);
 
-            static inline float s_opacity = 1.0F;
+                            if (!this->m_glyphCache.contains(key) && !this->m_queuedGlyphs.contains(key))
+                                this->queueGlyph({ key, this->lookupGlyph(currCharacter), cachedFontSize, this->m_glyphPrewarmSet.monospace, phase });
+                        }
+                    }
+                }
+            }
 
             /**
-             * @brief Get the current framebuffer address
-             *
-             * @return Framebuffer address
+             * @brief Drops the pre-warm glyphs the worker didn't get to yet and adds the finished ones to the cache
+             * @note Glyphs it didn't get to get rasterized when first drawn, like any other glyph
              */
-            inline void* getCurrentFramebuffer() {
-                return this->m_currentFramebuffer;
+            void finishGlyphPrewarm() {
+                {
+                    std::scoped_lock lock(this->m_glyphWorkerMutex);
+                    for (const auto &job : this->m_glyphJobs)
+                        this->m_queuedGlyphs.erase(job.key);
+
+                    this->m_glyphJobs.clear();
+                }
+
+                this->collectRasterizedGlyphs();
             }
 
             /**
-             * @brief Get the next framebuffer address
+             * @brief Blends the color channels of a framebuffer pixel with a color
+             * @note Same results as calling \ref blendColor for every channel
              *
-             * @return Next framebuffer address
+             * @param src Framebuffer pixel
+             * @param color Color
+             * @param alpha Opacity
+             * @return Blended pixel. Alpha channel is left empty
              */
-            inline void* getNextFramebuffer() {
-                return static_cast<u8*>(this->m_framebuffer.buf) + this->getNextFramebufferSlot() * this->getFramebufferSize();
+            static ALWAYS_INLINE u16 blendChannels(Color src, Color color, u8 alpha) {
+                const auto &table = Renderer::BlendTable[alpha];
+
+                return table[src.r][color.r] | table[src.g][color.g] << 4 | table[src.b][color.b] << 8;
             }
 
+        #if defined(__ARM_NEON)
+
             /**
-             * @brief Get the framebuffer size
+             * @brief Blends the color channels of 8 framebuffer pixels at once
              *
-             * @return Framebuffer size
+             * @param dst Framebuffer pixels
+             * @param oneMinusAlpha Inverted opacity of every pixel
+             * @param r Red channel of the colors, premultiplied by their opacity
+             * @param g Green channel of the colors, premultiplied by their opacity
+             * @param b Blue channel of the colors, premultiplied by their opacity
+             * @return Blended pixels. Alpha channels are left empty
              */
-            inline size_t getFramebufferSize() {
-                return this->m_framebuffer.fb_size;
+            static ALWAYS_INLINE uint16x8_t blendChannels(uint16x8_t dst, uint16x8_t oneMinusAlpha, uint16x8_t r, uint16x8_t g, uint16x8_t b) {
+                const uint16x8_t mask = vdupq_n_u16(0xF);
+
+                r = vmlaq_u16(r, vandq_u16(dst, mask), oneMinusAlpha);
+                g = vmlaq_u16(g, vandq_u16(vshrq_n_u16(dst, 4), mask), oneMinusAlpha);
+                b = vmlaq_u16(b, vandq_u16(vshrq_n_u16(dst, 8), mask), oneMinusAlpha);
+
+                // x / 15 == (x * 137) >> 11 for every x <= 15 * 15
+                r = vshrq_n_u16(vmulq_n_u16(r, 137), 11);
+                g = vshrq_n_u16(vmulq_n_u16(g, 137), 11);
+                b = vshrq_n_u16(vmulq_n_u16(b, 137), 11);
+
+                return vorrq_u16(r, vorrq_u16(vshlq_n_u16(g, 4), vshlq_n_u16(b, 8)));
             }
 
+        #endif
+
             /**
-             * @brief Get the number of framebuffers in use
+             * @brief Destination blends a color onto a contiguous run of framebuffer pixels
              *
-             * @return Number of framebuffers
+             * @param span First pixel of the run
+             * @param count Number of pixels
+             * @param color Color
              */
-            inline size_t getFramebufferCount() {
-                return this->m_framebuffer.num_fbs;
+            static void blendSpanDst(u16 *span, s32 count, Color color) {
+                s32 i = 0;
+
+            #if defined(__ARM_NEON)
+                const uint16x8_t alpha = vdupq_n_u16(color.a);
+                const uint16x8_t oneMinusAlpha = vdupq_n_u16(0xF - color.a);
+                const uint16x8_t r = vdupq_n_u16(color.r * color.a);
+                const uint16x8_t g = vdupq_n_u16(color.g * color.a);
+                const uint16x8_t b = vdupq_n_u16(color.b * color.a);
+
+                for (; i + 8 <= count; i += 8) {
+                    const uint16x8_t dst = vld1q_u16(span + i);
+                    const uint16x8_t endAlpha = vminq_u16(vaddq_u16(vshrq_n_u16(dst, 12), alpha), vdupq_n_u16(0xF));
+
+                    vst1q_u16(span + i, vorrq_u16(blendChannels(dst, oneMinusAlpha, r, g, b), vshlq_n_u16(endAlpha, 12)));
+                }
+            #endif
+
+                for (; i < count; i++) {
+                    const Color src(span[i]);
+
+                    span[i] = blendChannels(src, color, color.a) | std::min(color.a + src.a, 0xF) << 12;
+                }
             }
 
             /**
-             * @brief Get the currently used framebuffer's slot
+             * @brief Draws a run of packed 4 bit coverage values (e.g. a glyph row) onto a contiguous run of framebuffer pixels
+             * @note Fully covered pixels are overwritten with the color, all others are destination blended
              *
-             * @return Slot
+             * @param span First pixel of the run
+             * @param coverage Coverage row, two pixels per byte with the left one in the lower nibble
+             * @param first Index of the run's first pixel within the coverage row
+             * @param count Number of pixels
+             * @param color Color
+             * @param alphaTable Opacity to blend with for each of the 16 coverage levels
              */
-            inline u8 getCurrentFramebufferSlot() {
-                return this->m_window.cur_slot;
+            static void blendSpanCoverage(u16 *span, const u8 *coverage, s32 first, s32 count, Color color, const LevelTable &alphaTable) {
+                s32 i = 0;
+
+            #if defined(__ARM_NEON)
+                const uint8x16_t table = vld1q_u8(alphaTable.data());
+                const uint16x8_t solidColor = vdupq_n_u16(color.rgba);
+
+                for (; i + 8 <= count; i += 8) {
+                    // Unpack the 8 bytes holding the run into 16 levels and pick the 8 starting at the first pixel
+                    const uint8x8_t packed = vld1_u8(coverage + ((first + i) >> 1));
+                    const uint8x8x2_t levels = vzip_u8(vand_u8(packed, vdup_n_u8(0xF)), vshr_n_u8(packed, 4));
+                    const uint8x8_t level = ((first + i) & 1) ? vext_u8(levels.val[0], levels.val[1], 1) : levels.val[0];
+                    const uint16x8_t alpha = vmovl_u8(vqtbl1_u8(table, level));
+                    const uint16x8_t oneMinusAlpha = vsubq_u16(vdupq_n_u16(0xF), alpha);
+
+                    const uint16x8_t dst = vld1q_u16(span + i);
+                    const uint16x8_t endAlpha = vminq_u16(vaddq_u16(vshrq_n_u16(dst, 12), alpha), vdupq_n_u16(0xF));
+                    const uint16x8_t blended = vorrq_u16(blendChannels(dst, oneMinusAlpha, vmulq_n_u16(alpha, color.r), vmulq_n_u16(alpha, color.g), vmulq_n_u16(alpha, color.b)), vshlq_n_u16(endAlpha, 12));
+
+                    // Blending with an opacity of 0 leaves the pixel untouched, only full coverage needs special casing
+                    const uint16x8_t solid = vceqq_u16(vmovl_u8(level), vdupq_n_u16(0xF));
+                    vst1q_u16(span + i, vbslq_u16(solid, solidColor, blended));
+                }
+            #endif
+
+                for (; i < count; i++) {
+                    const u8 level = (coverage[(first + i) >> 1] >> (((first + i) & 1) * 4)) & 0xF;
+
+                    if (level == 0xF) {
+                        span[i] = color.rgba;
+                    } else if (level != 0x0) {
+                        const Color src(span[i]);
+                        const u8 alpha = alphaTable[level];
+
+                        span[i] = blendChannels(src, color, alpha) | std::min(alpha + src.a, 0xF) << 12;
+                    }
+                }
             }
 
             /**
-             * @brief Get the next framebuffer's slot
+             * @brief Source blends a run of RGBA8888 pixels onto a contiguous run of framebuffer pixels
              *
-             * @return Next slot
+             * @param span First pixel of the run
+             * @param rgba RGBA8888 pixel data
+             * @param count Number of pixels
+             * @param alphaTable Opacity to blend with for each of the 16 alpha levels
              */
-            inline u8 getNextFramebufferSlot() {
-                return (this->getCurrentFramebufferSlot() + 1) % this->getFramebufferCount();
+            static void blendSpanBitmap(u16 *span, const u8 *rgba, s32 count, const LevelTable &alphaTable) {
+                s32 i = 0;
+
+            #if defined(__ARM_NEON)
+                const uint8x16_t table = vld1q_u8(alphaTable.data());
+
+                for (; i + 8 <= count; i += 8) {
+                    const uint8x8x4_t pixels = vld4_u8(rgba + i * 4);
+                    const uint16x8_t alpha = vmovl_u8(vqtbl1_u8(table, vshr_n_u8(pixels.val[3], 4)));
+                    const uint16x8_t oneMinusAlpha = vsubq_u16(vdupq_n_u16(0xF), alpha);
+
+                    const uint16x8_t r = vmulq_u16(vmovl_u8(vshr_n_u8(pixels.val[0], 4)), alpha);
+                    const uint16x8_t g = vmulq_u16(vmovl_u8(vshr_n_u8(pixels.val[1], 4)), alpha);
+                    const uint16x8_t b = vmulq_u16(vmovl_u8(vshr_n_u8(pixels.val[2], 4)), alpha);
+
+                    const uint16x8_t dst = vld1q_u16(span + i);
+                    vst1q_u16(span + i, vorrq_u16(blendChannels(dst, oneMinusAlpha, r, g, b), vandq_u16(dst, vdupq_n_u16(0xF000))));
+                }
+            #endif
+
+                for (; i < count; i++) {
+                    const u8 *pixel = rgba + i * 4;
+                    const Color src(span[i]);
+                    const Color color = { static_cast<u8>(pixel[0] >> 4), static_cast<u8>(pixel[1] >> 4), static_cast<u8>(pixel[2] >> 4), 0x0 };
+
+                    span[i] = blendChannels(src, color, alphaTable[pixel[3] >> 4]) | (src.rgba & 0xF000);
+                }
             }
 
             /**
-             * @brief Waits for the vsync event
+             * @brief Copies the color channels of a run of opaque RGBA4444 pixels onto a contiguous run of framebuffer pixels
+             * @note The framebuffer's alpha is kept, the same as source blending at full opacity
              *
+             * @param span First pixel of the run
+             * @param pixels RGBA4444 pixel data
+             * @param count Number of pixels
              */
-            inline void waitForVSync() {
-                eventWait(&this->m_vsyncEvent, UINT64_MAX);
+            static void copySpanTexture(u16 *span, const u16 *pixels, s32 count) {
+                s32 i = 0;
+
+            #if defined(__ARM_NEON)
+                for (; i + 8 <= count; i += 8)
+                    vst1q_u16(span + i, vbslq_u16(vdupq_n_u16(0x0FFF), vld1q_u16(pixels + i), vld1q_u16(span + i)));
+            #endif
+
+                for (; i < count; i++)
+                    span[i] = (pixels[i] & 0x0FFF) | (span[i] & 0xF000);
             }
 
             /**
-             * @brief Decodes a x and y coordinate into a offset into the swizzled framebuffer
+             * @brief Source blends a run of RGBA4444 pixels onto a contiguous run of framebuffer pixels
              *
-             * @param x X pos
-             * @param y Y Pos
-             * @return Offset
+             * @param span First pixel of the run
+             * @param pixels RGBA4444 pixel data
+             * @param count Number of pixels
+             * @param alphaTable Opacity to blend with for each of the 16 alpha levels
              */
-            u32 getPixelOffset(s32 x, s32 y) {
-                if (!this->m_scissoringStack.empty()) {
-                    auto currScissorConfig = this->m_scissoringStack.top();
-                    if (x < currScissorConfig.x ||
-                        y < currScissorConfig.y ||
-                        x > currScissorConfig.x + currScissorConfig.w ||
-                        y > currScissorConfig.y + currScissorConfig.h)
-                            return UINT32_MAX;
-                }
+            static void blendSpanTexture(u16 *span, const u16 *pixels, s32 count, const LevelTable &alphaTable) {
+                s32 i = 0;
 
-                u32 tmpPos = ((y & 127) / 16) + (x / 32 * 8) + ((y / 16 / 8) * (((cfg::FramebufferWidth / 2) / 16 * 8)));
-                tmpPos *= 16 * 16 * 4;
+            #if defined(__ARM_NEON)
+                const uint8x16_t table = vld1q_u8(alphaTable.data());
+                const uint16x8_t mask = vdupq_n_u16(0xF);
 
-                tmpPos += ((y % 16) / 8) * 512 + ((x % 32) / 16) * 256 + ((y % 8) / 2) * 64 + ((x % 16) / 8) * 32 + (y % 2) * 16 + (x % 8) * 2;
+                for (; i + 8 <= count; i += 8) {
+                    const uint16x8_t color = vld1q_u16(pixels + i);
+                    const uint16x8_t alpha = vmovl_u8(vqtbl1_u8(table, vmovn_u16(vshrq_n_u16(color, 12))));
+                    const uint16x8_t oneMinusAlpha = vsubq_u16(mask, alpha);
 
-                return tmpPos / 2;
+                    const uint16x8_t r = vmulq_u16(vandq_u16(color, mask), alpha);
+                    const uint16x8_t g = vmulq_u16(vandq_u16(vshrq_n_u16(color, 4), mask), alpha);
+                    const uint16x8_t b = vmulq_u16(vandq_u16(vshrq_n_u16(color, 8), mask), alpha);
+
+                    const uint16x8_t dst = vld1q_u16(span + i);
+                    vst1q_u16(span + i, vorrq_u16(blendChannels(dst, oneMinusAlpha, r, g, b), vandq_u16(dst, vdupq_n_u16(0xF000))));
+                }
+            #endif
+
+                for (; i < count; i++) {
+                    const Color src(span[i]);
+                    const Color color(pixels[i]);
+
+                    span[i] = blendChannels(src, color, alphaTable[color.a]) | (src.rgba & 0xF000);
+                }
             }
 
             /**
@@ -1035,6 +4234,11 @@ namespace tsl {
                 cfg::LayerWidth  = cfg::ScreenHeight * (float(cfg::FramebufferWidth) / float(cfg::FramebufferHeight));
                 cfg::LayerHeight = cfg::ScreenHeight;
 
+                this->initPixelOffsetTables();
+
+                // Nothing has been drawn to any of the framebuffers yet
+                this->addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+
                 if (this->m_initialized)
                     return;
 
@@ -1062,12 +4266,17 @@ namespace tsl {
                     ASSERT_FATAL(viSetLayerSize(&this->m_layer, cfg::LayerWidth, cfg::LayerHeight));
                     ASSERT_FATAL(viSetLayerPosition(&this->m_layer, cfg::LayerPosX, cfg::LayerPosY));
                     ASSERT_FATAL(nwindowCreateFromLayer(&this->m_window, &this->m_layer));
-                    ASSERT_FATAL(framebufferCreate(&this->m_framebuffer, &this->m_window, cfg::FramebufferWidth, cfg::FramebufferHeight, PIXEL_FORMAT_RGBA_4444, 2));
+                    ASSERT_FATAL(framebufferCreate(&this->m_framebuffer, &this->m_window, cfg::FramebufferWidth, cfg::FramebufferHeight, PIXEL_FORMAT_RGBA_4444, FramebufferCount));
                     ASSERT_FATAL(setInitialize());
                     ASSERT_FATAL(this->initFonts());
                     setExit();
                 });
 
+                if (Renderer::s_persistentGlyphAtlas) {
+                    this->loadGlyphAtlas();
+                    this->m_glyphAtlasSaveTick = armGetSystemTick();
+                }
+
                 this->m_initialized = true;
             }
 
@@ -1079,6 +4288,15 @@ namespace tsl {
                 if (!this->m_initialized)
                     return;
 
+                this->stopGlyphWorker();
+                this->stopRasterizerThreads();
+
+                // Write back the glyphs added since the last save, after any write still in progress
+                this->joinGlyphAtlasWriter();
+                if (Renderer::s_persistentGlyphAtlas)
+                    this->saveGlyphAtlas();
+                this->joinGlyphAtlasWriter();
+
                 framebufferClose(&this->m_framebuffer);
                 nwindowClose(&this->m_window);
                 viDestroyManagedLayer(&this->m_layer);
@@ -1136,15 +4354,59 @@ namespace tsl {
                 fontBuffer = reinterpret_cast<u8*>(extFontData.address);
                 stbtt_InitFont(&this->m_extFont, fontBuffer, stbtt_GetFontOffsetForIndex(fontBuffer, 0));
 
+                this->initGlyphIndex();
+
                 return 0;
             }
 
+            /**
+             * @brief Checks if any framebuffer has areas left that need to be repainted
+             * @note Always true without damage tracking, since changes might not have been reported
+             *
+             * @return Whether a frame needs to be drawn
+             */
+            inline bool hasDamage() {
+                if (!Renderer::s_damageTracking)
+                    return true;
+
+                return std::any_of(this->m_framebufferDamage.begin(), this->m_framebufferDamage.end(), [](const auto &damage) {
+                    return damage.w > 0 && damage.h > 0;
+                });
+            }
+
+            /**
+             * @brief Lets a frame pass without drawing anything, the framebuffer currently on screen stays up
+             *
+             */
+            inline void skipFrame() {
+                this->waitForVSync();
+
+                this->m_stats.skippedFrames++;
+            }
+
             /**
              * @brief Start a new frame
              * @warning Don't call this more than once before calling \ref endFrame
              */
             inline void startFrame() {
                 this->m_currentFramebuffer = framebufferBegin(&this->m_framebuffer, nullptr);
+                this->m_recording = Renderer::s_recordingEnabled;
+
+                // The framebuffer still holds what was drawn to it the last time, only the areas that changed since then need repainting
+                auto &damage = this->m_framebufferDamage[this->getCurrentFramebufferSlot() % FramebufferCount];
+                if (Renderer::s_damageTracking)
+                    this->m_frameDamage = damage;
+                else
+                    this->m_frameDamage = { 0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight };
+
+                damage = { };
+
+                this->m_glyphRasterizationTicks = 0;
+
+                const u32 redrawnPixels = std::max(this->m_frameDamage.w, 0) * std::max(this->m_frameDamage.h, 0);
+                this->m_stats.renderedFrames++;
+                this->m_stats.redrawnPixels += redrawnPixels;
+                this->m_stats.lastRedrawnPixels = redrawnPixels;
             }
 
             /**
@@ -1152,6 +4414,18 @@ namespace tsl {
              * @warning Don't call this before calling \ref startFrame once
              */
             inline void endFrame() {
+                if (this->m_recording) {
+                    this->flushDrawCommands();
+                    this->m_recording = false;
+                }
+
+                // Nothing refers to the cached glyphs and sprites anymore now that the frame is drawn
+                this->m_glyphCache.evict(Renderer::s_glyphCacheBudget);
+                this->m_textSprites.evict(Renderer::s_textSpriteCacheBudget);
+
+                if (Renderer::s_persistentGlyphAtlas && armTicksToNs(armGetSystemTick() - this->m_glyphAtlasSaveTick) >= GlyphAtlasSaveIntervalNs)
+                    this->saveGlyphAtlas();
+
                 this->waitForVSync();
                 framebufferEnd(&this->m_framebuffer);
 
@@ -1159,6 +4433,11 @@ namespace tsl {
             }
         };
 
+    #ifdef TESLA_SELF_TEST
+        static_assert(Renderer::checkSwizzledOffsets(448, 720), "Swizzled pixel offsets don't match the block-linear layout");
+        static_assert(Renderer::checkBlendTables(), "Blending tables don't match the float blending math");
+    #endif
+
     }
 
     // Elements
@@ -1260,21 +4539,17 @@ namespace tsl {
              * @param renderer
              */
             void frame(gfx::Renderer *renderer) {
-                renderer->enableScissoring(0, 0, tsl::cfg::FramebufferWidth, tsl::cfg::FramebufferHeight);
-
                 if (this->m_focused)
                     this->drawFocusBackground(renderer);
 
-                renderer->disableScissoring();
-
                 this->draw(renderer);
 
-                renderer->enableScissoring(0, 0, tsl::cfg::FramebufferWidth, tsl::cfg::FramebufferHeight);
-
-                if (this->m_focused)
+                if (this->m_focused) {
                     this->drawHighlight(renderer);
 
-                renderer->disableScissoring();
+                    // The highlight is animated for as long as the element is focused
+                    this->markDirty();
+                }
             }
 
             /**
@@ -1284,10 +4559,25 @@ namespace tsl {
             void invalidate() {
                 const auto& parent = this->getParent();
 
+                this->markDirty();
+
                 if (parent == nullptr)
                     this->layout(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
                 else
                     this->layout(ELEMENT_BOUNDS(parent));
+
+                this->markDirty();
+            }
+
+            /**
+             * @brief Marks the element as changed so it gets redrawn
+             * @note Only required when damage tracking is enabled. Also covers the area the element's highlight can be drawn to
+             *
+             */
+            void markDirty() {
+                constexpr s32 Margin = tsl::style::ElementHighlightMargin;
+
+                this->markAreaDirty(this->getX() - Margin, this->getY() - Margin, this->getWidth() + 2 * Margin, this->getHeight() + 2 * Margin);
             }
 
             /**
@@ -1487,12 +4777,26 @@ namespace tsl {
             virtual inline void setFocused(bool focused) {
                 this->m_focused = focused;
                 this->m_clickAnimationProgress = 0;
+                this->markDirty();
             }
 
+            /**
+             * @brief Gets whether this element is focused and draws the highlight
+             *
+             * @return Focused
+             */
+            inline bool hasFocus() { return this->m_focused; }
+
 
             static InputMode getInputMode() { return Element::s_inputMode; }
 
-            static void setInputMode(InputMode mode) { Element::s_inputMode = mode; }
+            static void setInputMode(InputMode mode) {
+                // Elements look different depending on the input mode
+                if (mode != Element::s_inputMode)
+                    gfx::Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+
+                Element::s_inputMode = mode;
+            }
 
         protected:
             constexpr static inline auto a = &gfx::Renderer::a;
@@ -1506,6 +4810,19 @@ namespace tsl {
 
             static inline InputMode s_inputMode;
 
+            /**
+             * @brief Marks an area as changed so it gets redrawn
+             * @note Use this for things a element draws outside of its own boundaries
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param w Width
+             * @param h Height
+             */
+            void markAreaDirty(s32 x, s32 y, s32 w, s32 h) {
+                gfx::Renderer::get().addDamage(x, y, w, h);
+            }
+
             /**
              * @brief Shake animation callculation based on a damped sine wave
              *
@@ -1550,6 +4867,9 @@ namespace tsl {
                 renderer->enableScissoring(ELEMENT_BOUNDS(this));
                 this->m_renderFunc(renderer, ELEMENT_BOUNDS(this));
                 renderer->disableScissoring();
+
+                // There's no way of knowing whether the render function draws something different next frame
+                this->markAreaDirty(ELEMENT_BOUNDS(this));
             }
 
             virtual void layout(u16 parentX, u16 parentY, u16 parentWidth, u16 parentHeight) override {
@@ -1583,12 +4903,12 @@ namespace tsl {
                 renderer->fillScreen(a(tsl::style::color::ColorFrameBackground));
                 renderer->drawRect(tsl::cfg::FramebufferWidth - 1, 0, 1, tsl::cfg::FramebufferHeight, a(0xF222));
 
-                renderer->drawString(this->m_title.c_str(), false, 20, 50, 30, a(tsl::style::color::ColorText));
-                renderer->drawString(this->m_subtitle.c_str(), false, 20, 70, 15, a(tsl::style::color::ColorDescription));
+                renderer->drawCachedString(this->m_title, false, 20, 50, 30, a(tsl::style::color::ColorText));
+                renderer->drawCachedString(this->m_subtitle, false, 20, 70, 15, a(tsl::style::color::ColorDescription));
 
                 renderer->drawRect(15, tsl::cfg::FramebufferHeight - 73, tsl::cfg::FramebufferWidth - 30, 1, a(tsl::style::color::ColorText));
 
-                renderer->drawString("\uE0E1  Back     \uE0E0  OK", false, 30, 693, 23, a(tsl::style::color::ColorText));
+                renderer->drawCachedString("\uE0E1  Back     \uE0E0  OK", false, 30, 693, 23, a(tsl::style::color::ColorText));
 
                 if (this->m_contentElement != nullptr)
                     this->m_contentElement->frame(renderer);
@@ -1644,6 +4964,7 @@ namespace tsl {
              */
             void setTitle(const std::string &title) {
                 this->m_title = title;
+                this->markDirty();
             }
 
             /**
@@ -1653,6 +4974,7 @@ namespace tsl {
              */
             void setSubtitle(const std::string &subtitle) {
                 this->m_subtitle = subtitle;
+                this->markDirty();
             }
 
         protected:
@@ -1682,7 +5004,7 @@ namespace tsl {
 
                 renderer->drawRect(15, tsl::cfg::FramebufferHeight - 73, tsl::cfg::FramebufferWidth - 30, 1, a(tsl::style::color::ColorText));
 
-                renderer->drawString("\uE0E1  Back     \uE0E0  OK", false, 30, 693, 23, a(tsl::style::color::ColorText));
+                renderer->drawCachedString("\uE0E1  Back     \uE0E0  OK", false, 30, 693, 23, a(tsl::style::color::ColorText));
 
                 if (this->m_header != nullptr)
                     this->m_header->frame(renderer);
@@ -1845,16 +5167,22 @@ namespace tsl {
                 }
                 this->m_itemsToRemove.clear();
 
-                renderer->enableScissoring(this->getLeftBound(), this->getTopBound() - 5, this->getWidth(), this->getHeight() + 4);
+                constexpr s32 HighlightMargin = tsl::style::ElementHighlightMargin;
 
                 for (auto &entry : this->m_items) {
                     if (entry->getBottomBound() > this->getTopBound() && entry->getTopBound() < this->getBottomBound()) {
+                        // Leave room on all sides for the highlight of the focused item and its shake animation
+                        if (entry->hasFocus())
+                            renderer->enableScissoring(this->getLeftBound() - HighlightMargin, this->getTopBound() - HighlightMargin, this->getWidth() + 2 * HighlightMargin, this->getHeight() + 2 * HighlightMargin);
+                        else
+                            renderer->enableScissoring(this->getLeftBound(), this->getTopBound() - 5, this->getWidth(), this->getHeight() + 4);
+
                         entry->frame(renderer);
+
+                        renderer->disableScissoring();
                     }
                 }
 
-                renderer->disableScissoring();
-
                 if (this->m_listHeight > this->getHeight()) {
                     float scrollbarHeight = static_cast<float>(this->getHeight() * this->getHeight()) / this->m_listHeight;
                     float scrollbarOffset = (static_cast<double>(this->m_offset)) / static_cast<double>(this->m_listHeight - this->getHeight()) * (this->getHeight() - std::ceil(scrollbarHeight));
@@ -1872,6 +5200,10 @@ namespace tsl {
 
                     if (static_cast<u32>(prevOffset) != static_cast<u32>(this->m_offset))
                         this->invalidate();
+
+                    // The scroll bar moves with the fractional offset as well
+                    if (prevOffset != this->m_offset)
+                        this->markScrollBarDirty();
                 }
 
             }
@@ -1879,6 +5211,8 @@ namespace tsl {
             virtual void layout(u16 parentX, u16 parentY, u16 parentWidth, u16 parentHeight) override {
                 s32 y = this->getY() - this->m_offset;
 
+                this->markScrollBarDirty();
+
                 this->m_listHeight = 0;
                 for (auto &entry : this->m_items)
                     this->m_listHeight += entry->getHeight();
@@ -1909,6 +5243,9 @@ namespace tsl {
                     if (prevX != 0 && prevY != 0)
                         this->m_nextOffset += (prevY - currY);
 
+                    // Scrolling itself happens while drawing
+                    this->markScrollBarDirty();
+
                     if (this->m_nextOffset < 0)
                         this->m_nextOffset = 0;
 
@@ -2084,6 +5421,13 @@ namespace tsl {
 
         private:
 
+            /**
+             * @brief Marks the scroll bar drawn to the right of the list as changed
+             */
+            void markScrollBarDirty() {
+                this->markAreaDirty(this->getRightBound(), this->getTopBound() - 2, 16, this->getHeight() + 4);
+            }
+
             virtual void updateScrollOffset() {
                 if (this->getInputMode() != InputMode::Controller)
                     return;
@@ -2091,6 +5435,7 @@ namespace tsl {
                 if (this->m_listHeight <= this->getHeight()) {
                     this->m_nextOffset = 0;
                     this->m_offset = 0;
+                    this->markDirty();
 
                     return;
                 }
@@ -2106,6 +5451,9 @@ namespace tsl {
 
                 if (this->m_nextOffset > (this->m_listHeight - this->getHeight()) + 50)
                     this->m_nextOffset = (this->m_listHeight - this->getHeight() + 50);
+
+                // Scrolling towards the new offset happens while drawing
+                this->markScrollBarDirty();
             }
         };
 
@@ -2132,19 +5480,18 @@ namespace tsl {
 
                 if (this->m_maxWidth == 0) {
                     if (this->m_value.length() > 0) {
-                        auto [valueWidth, valueHeight] = renderer->drawString(this->m_value.c_str(), false, 0, 0, 20, tsl::style::color::ColorTransparent);
+                        auto [valueWidth, valueHeight] = renderer->measureString(this->m_value, false, 20);
                         this->m_maxWidth = this->getWidth() - valueWidth - 70;
                     } else {
                         this->m_maxWidth = this->getWidth() - 40;
                     }
 
-                    auto [width, height] = renderer->drawString(this->m_text.c_str(), false, 0, 0, 23, tsl::style::color::ColorTransparent);
+                    auto [width, height] = renderer->measureString(this->m_text, false, 23);
                     this->m_trunctuated = width > this->m_maxWidth;
 
                     if (this->m_trunctuated) {
                         this->m_scrollText = this->m_text + "        ";
-                        auto [width, height] = renderer->drawString(this->m_scrollText.c_str(), false, 0, 0, 23, tsl::style::color::ColorTransparent);
-                        this->m_scrollText += this->m_text;
+                        auto [width, height] = renderer->measureString(this->m_scrollText, false, 23);
                         this->m_textWidth = width;
                         this->m_ellipsisText = renderer->limitStringLength(this->m_text, false, 22, this->m_maxWidth);
                     } else {
@@ -2157,19 +5504,23 @@ namespace tsl {
 
                 if (this->m_trunctuated) {
                     if (this->m_focused) {
-                        renderer->enableScissoring(this->getX(), this->getY(), this->m_maxWidth + 40, this->getHeight());
-                        renderer->drawString(this->m_scrollText.c_str(), false, this->getX() + 20 - this->m_scrollOffset, this->getY() + 45, 23, tsl::style::color::ColorText);
-                        renderer->disableScissoring();
-                        if (this->m_scrollAnimationCounter == 90) {
-                            if (this->m_scrollOffset == this->m_textWidth) {
-                                this->m_scrollOffset = 0;
-                                this->m_scrollAnimationCounter = 0;
-                            } else {
-                                this->m_scrollOffset++;
-                            }
+                        const auto now = std::chrono::steady_clock::now();
+                        const s64 scrollTime = std::chrono::duration_cast<std::chrono::milliseconds>(now - this->m_scrollStartTime - tsl::style::ListItemScrollDelay).count();
+
+                        // Checked before narrowing, the item may have stayed focused while the overlay was hidden for a long time
+                        const s64 scrollOffset = std::max<s64>(scrollTime, 0) * tsl::style::ListItemScrollSpeed / 1000;
+                        if (scrollOffset >= this->m_textWidth) {
+                            this->m_scrollOffset = 0;
+                            this->m_scrollStartTime = now;
                         } else {
-                            this->m_scrollAnimationCounter++;
+                            this->m_scrollOffset = scrollOffset;
                         }
+
+                        // The text and its gap are rendered once into a sprite. Scrolling only moves where it gets blitted, a second copy follows right behind it
+                        renderer->enableScissoring(this->getX(), this->getY(), this->m_maxWidth + 40, this->getHeight());
+                        renderer->drawCachedString(this->m_scrollText, false, this->getX() + 20 - this->m_scrollOffset, this->getY() + 45, 23, tsl::style::color::ColorText);
+                        renderer->drawCachedString(this->m_scrollText, false, this->getX() + 20 - this->m_scrollOffset + this->m_textWidth, this->getY() + 45, 23, tsl::style::color::ColorText);
+                        renderer->disableScissoring();
                     } else {
                         renderer->drawString(this->m_ellipsisText.c_str(), false, this->getX() + 20, this->getY() + 45, 23, a(tsl::style::color::ColorText));
                     }
@@ -2195,11 +5546,16 @@ namespace tsl {
 
 
             virtual bool onTouch(TouchEvent event, s32 currX, s32 currY, s32 prevX, s32 prevY, s32 initialX, s32 initialY) override {
-                if (event == TouchEvent::Touch)
+                if (event == TouchEvent::Touch) {
                     this->m_touched = this->inBounds(currX, currY);
 
+                    if (this->m_touched)
+                        this->markDirty();
+                }
+
                 if (event == TouchEvent::Release && this->m_touched) {
                     this->m_touched = false;
+                    this->markDirty();
 
                     if (Element::getInputMode() == InputMode::Touch) {
                         bool handled = this->onClick(HidNpadButton_A);
@@ -2217,7 +5573,7 @@ namespace tsl {
             virtual void setFocused(bool state) override {
                 this->m_scroll = false;
                 this->m_scrollOffset = 0;
-                this->m_scrollAnimationCounter = 0;
+                this->m_scrollStartTime = std::chrono::steady_clock::now();
                 Element::setFocused(state);
             }
 
@@ -2235,6 +5591,7 @@ namespace tsl {
                 this->m_scrollText = "";
                 this->m_ellipsisText = "";
                 this->m_maxWidth = 0;
+                this->markDirty();
             }
 
             /**
@@ -2247,6 +5604,7 @@ namespace tsl {
                 this->m_value = value;
                 this->m_faint = faint;
                 this->m_maxWidth = 0;
+                this->markDirty();
             }
 
             /**
@@ -2283,7 +5641,7 @@ namespace tsl {
             u16 m_scrollOffset = 0;
             u32 m_maxWidth = 0;
             u32 m_textWidth = 0;
-            u16 m_scrollAnimationCounter = 0;
+            std::chrono::steady_clock::time_point m_scrollStartTime;
         };
 
         /**
@@ -2367,7 +5725,7 @@ namespace tsl {
 
             virtual void draw(gfx::Renderer *renderer) override {
                 renderer->drawRect(this->getX() - 2, this->getBottomBound() - 30, 5, 23, a(tsl::style::color::ColorHeaderBar));
-                renderer->drawString(this->m_text.c_str(), false, this->getX() + 13, this->getBottomBound() - 12, 15, a(tsl::style::color::ColorText));
+                renderer->drawCachedString(this->m_text, false, this->getX() + 13, this->getBottomBound() - 12, 15, a(tsl::style::color::ColorText));
 
                 if (this->m_hasSeparator)
                     renderer->drawRect(this->getX(), this->getBottomBound(), this->getWidth(), 1, a(tsl::style::color::ColorFrame));
@@ -2395,6 +5753,7 @@ namespace tsl {
 
             inline void setText(const std::string &text) {
                 this->m_text = text;
+                this->markDirty();
             }
 
             inline const std::string& getText() const {
@@ -2432,6 +5791,7 @@ namespace tsl {
                 if (keysHeld & HidNpadButton_AnyLeft) {
                     if (this->m_value > 0) {
                         this->m_value--;
+                        this->markDirty();
                         this->m_valueChangedListener(this->m_value);
                         return true;
                     }
@@ -2440,6 +5800,7 @@ namespace tsl {
                 if (keysHeld & HidNpadButton_AnyRight) {
                     if (this->m_value < 100) {
                         this->m_value++;
+                        this->markDirty();
                         this->m_valueChangedListener(this->m_value);
                         return true;
                     }
@@ -2467,6 +5828,7 @@ namespace tsl {
 
                         if (newValue != this->m_value) {
                             this->m_value = newValue;
+                            this->markDirty();
                             this->m_valueChangedListener(this->getProgress());
                         }
 
@@ -2547,9 +5909,7 @@ namespace tsl {
                     }
                 }
 
-                for (u8 i = 16; i <= 19; i++) {
-                    renderer->drawCircle(this->getX() + 62 + x + handlePos, this->getY() + 42 + y, i, false, a(highlightColor));
-                }
+                renderer->drawRing(this->getX() + 62 + x + handlePos, this->getY() + 42 + y, 19, 4, a(highlightColor));
             }
 
             /**
@@ -2568,6 +5928,7 @@ namespace tsl {
              */
             virtual void setProgress(u8 value) {
                 this->m_value = value;
+                this->markDirty();
             }
 
             /**
@@ -2622,6 +5983,7 @@ namespace tsl {
                         } else {
                             return false;
                         }
+                        this->markDirty();
                         this->m_valueChangedListener(this->getProgress());
                     }
                     tick++;
@@ -2648,6 +6010,7 @@ namespace tsl {
 
                         if (newValue != this->m_value) {
                             this->m_value = newValue;
+                            this->markDirty();
                             this->m_valueChangedListener(this->getProgress());
                         }
 
@@ -2675,6 +6038,7 @@ namespace tsl {
             virtual void setProgress(u8 value) override {
                 value = std::min(value, u8(this->m_numSteps - 1));
                 this->m_value = value * (100 / (this->m_numSteps - 1));
+                this->markDirty();
             }
 
         protected:
@@ -2710,7 +6074,7 @@ namespace tsl {
 
                 u8 currentDescIndex = std::clamp(this->m_value / (100 / (this->m_numSteps - 1)), 0, this->m_numSteps - 1);
 
-                auto [descWidth, descHeight] = renderer->drawString(this->m_stepDescriptions[currentDescIndex].c_str(), false, 0, 0, 15, tsl::style::color::ColorTransparent);
+                auto [descWidth, descHeight] = renderer->measureString(this->m_stepDescriptions[currentDescIndex], false, 15);
                 renderer->drawString(this->m_stepDescriptions[currentDescIndex].c_str(), false, ((this->getX() + 60) + (this->getWidth() - 95) / 2) - (descWidth / 2), this->getY() + 20, 15, a(tsl::style::color::ColorDescription));
 
                 StepTrackBar::draw(renderer);
@@ -2928,6 +6292,8 @@ namespace tsl {
          *
          */
         void show() {
+            gfx::Renderer::get().finishGlyphPrewarm();
+
             if (this->m_disableNextAnimation) {
                 this->m_animationCounter = 5;
                 this->m_disableNextAnimation = false;
@@ -2941,6 +6307,10 @@ namespace tsl {
 
             if (auto& currGui = this->getCurrentGui(); currGui != nullptr)
                 currGui->restoreFocus();
+
+            // The framebuffers got cleared while the overlay was hidden
+            gfx::Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+            this->m_framebuffersToRepaint = (1 << gfx::Renderer::FramebufferCount) - 1;
         }
 
         /**
@@ -3013,6 +6383,8 @@ namespace tsl {
 
         bool m_disableNextAnimation = false;
 
+        u8 m_framebuffersToRepaint = 0;
+
         bool m_closeOnExit;
 
         /**
@@ -3021,6 +6393,9 @@ namespace tsl {
          */
         void initScreen() {
             gfx::Renderer::get().init();
+
+            // Rasterize the common glyphs while waiting for the launch combo, so the first frame doesn't have to
+            gfx::Renderer::get().startGlyphPrewarm();
         }
 
         /**
@@ -3080,11 +6455,35 @@ namespace tsl {
         void loop() {
             auto& renderer = gfx::Renderer::get();
 
-            renderer.startFrame();
-
             this->animationLoop();
             this->getCurrentGui()->update();
+
+            // Glyphs finished in the background replace their placeholders
+            renderer.collectRasterizedGlyphs();
+
+            // Nothing reported a change since all framebuffers were last drawn to, so the one on screen is still up to date
+            if (!renderer.hasDamage()) {
+                assert(this->m_framebuffersToRepaint == 0);
+
+                renderer.skipFrame();
+                return;
+            }
+
+            renderer.startFrame();
+
+            // The first frame drawn to each framebuffer after showing the overlay has to cover all of it
+            const u8 slotMask = 1 << (renderer.getCurrentFramebufferSlot() % gfx::Renderer::FramebufferCount);
+            if (this->m_framebuffersToRepaint & slotMask) {
+                assert(renderer.m_frameDamage.x <= 0 && renderer.m_frameDamage.y <= 0);
+                assert(renderer.m_frameDamage.x + renderer.m_frameDamage.w >= cfg::FramebufferWidth && renderer.m_frameDamage.y + renderer.m_frameDamage.h >= cfg::FramebufferHeight);
+
+                this->m_framebuffersToRepaint &= ~slotMask;
+            }
+
+            // Everything outside of the damaged area is still up to date in this framebuffer
+            renderer.pushScissoring(renderer.m_frameDamage);
             this->getCurrentGui()->draw(&renderer);
+            renderer.disableScissoring();
 
             renderer.endFrame();
         }
@@ -3244,6 +6643,9 @@ namespace tsl {
             renderer.startFrame();
             renderer.clearScreen();
             renderer.endFrame();
+
+            // Starting the frame used up the framebuffer's damage, but everything on it got cleared
+            renderer.addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
         }
 
         /**
@@ -3277,6 +6679,8 @@ namespace tsl {
 
             this->m_guiStack.push(std::move(gui));
 
+            gfx::Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+
             return this->m_guiStack.top();
         }
 
@@ -3308,6 +6712,8 @@ namespace tsl {
 
             if (this->m_guiStack.empty())
                 this->close();
+            else
+                gfx::Renderer::get().addDamage(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
         }
 
         template<typename G, typename ...Args>